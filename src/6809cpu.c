@@ -19,43 +19,29 @@
 
 /* Motorola 6809 microprocessor emulation */
 
-//pointeurs vers fonctions d'acces memoire
-char (*Mgetc)(unsigned short a);
-void (*Mputc)(unsigned short a, char c);
-
-//global variables
-static int dc6809_cycles; //additional cycles
-static int dc6809_sync;   //synchronisation flag
-int dc6809_irq;    //irq trigger  (0=inactif)
-static int dc6809_firq;   //firq trigger (0=inactif)
-static int dc6809_nmi;    //nmi trigger  (0=inactif)
-static short dc6809_w;    //dc6809 work register
-
-//6809 registers
-char  dc6809_cc;   //condition code
-unsigned short dc6809_pc; //program counter
-static short dc6809_d;    //D register
-short dc6809_x;    //X register
-short dc6809_y;    //Y register
-short dc6809_u;    //U register
-short dc6809_s;    //S register
-static short dc6809_da;   //direct address (DP register = high byte of direct address)
+#include "6809cpu.h"
+
+//global variables (registers of the current machine: see 6809cpu.h)
+#define dc6809_cycles (machine->cpu.cycles) //additional cycles
+#define dc6809_sync (machine->cpu.sync)     //synchronisation flag
+#define dc6809_firq (machine->cpu.firq)     //firq trigger (0=inactif)
+#define dc6809_nmi (machine->cpu.nmi)       //nmi trigger  (0=inactif)
+#define dc6809_w (machine->cpu.w)           //dc6809 work register
+#define dc6809_d (machine->cpu.d)           //D register
+#define dc6809_da (machine->cpu.da)         //direct address (DP register = high byte of direct address)
 
 //pointers to register bytes
-char *dc6809_a;    //pointer to A register
-char *dc6809_b;    //pointer to B register
-char *dc6809_dp;   //pointer to DP register
-static char *dc6809_dd;   //pointer to direct address low byte
-static char *dc6809_pch;  //pointer to PC low byte
-static char *dc6809_pcl;  //pointer to PC high byte
-static char *dc6809_xh;   //pointer to X low byte
-static char *dc6809_xl;   //pointer to X high byte
-static char *dc6809_yh;   //pointer to Y low byte
-static char *dc6809_yl;   //pointer to Y high byte
-static char *dc6809_uh;   //pointer to U low byte
-static char *dc6809_ul;   //pointer to U high byte
-static char *dc6809_sh;   //pointer to S low byte
-static char *dc6809_sl;   //pointer to S high byte
+#define dc6809_dd (machine->cpu.dd)         //pointer to direct address low byte
+#define dc6809_pch (machine->cpu.pch)       //pointer to PC low byte
+#define dc6809_pcl (machine->cpu.pcl)       //pointer to PC high byte
+#define dc6809_xh (machine->cpu.xh)         //pointer to X low byte
+#define dc6809_xl (machine->cpu.xl)         //pointer to X high byte
+#define dc6809_yh (machine->cpu.yh)         //pointer to Y low byte
+#define dc6809_yl (machine->cpu.yl)         //pointer to Y high byte
+#define dc6809_uh (machine->cpu.uh)         //pointer to U low byte
+#define dc6809_ul (machine->cpu.ul)         //pointer to U high byte
+#define dc6809_sh (machine->cpu.sh)         //pointer to S low byte
+#define dc6809_sl (machine->cpu.sl)         //pointer to S high byte
 
 //aliases
 #define AP   dc6809_a
@@ -1014,79 +1000,59 @@ int Run6809(void)
   }
 }
 
+// Etat du processeur dans les sauvegardes
+typedef struct
+{
+  int cycles, sync, irq, firq, nmi;
+  short w, d, x, y, u, s, da;
+  unsigned short pc;
+  char cc;
+} CpuState;
+
 unsigned int cpu_serialize_size(void)
 {
-  return sizeof(dc6809_cycles) + sizeof(dc6809_sync) + sizeof(dc6809_irq)
-      + sizeof(dc6809_firq) + sizeof(dc6809_nmi) + sizeof(dc6809_w)
-      + sizeof(dc6809_cc) + sizeof(dc6809_pc) + sizeof(dc6809_d)
-      + sizeof(dc6809_x) + sizeof(dc6809_y) + sizeof(dc6809_u)
-      + sizeof(dc6809_s) + sizeof(dc6809_da);
+  return sizeof(CpuState);
 }
 
 #include <string.h>
 
 void cpu_serialize(void *data)
 {
-  int offset = 0;
-  char *buffer = (char *) data;
-  memcpy(buffer+offset, &dc6809_cycles, sizeof(dc6809_cycles));
-  offset += sizeof(dc6809_cycles);
-  memcpy(buffer+offset, &dc6809_sync, sizeof(dc6809_sync));
-  offset += sizeof(dc6809_sync);
-  memcpy(buffer+offset, &dc6809_irq, sizeof(dc6809_irq));
-  offset += sizeof(dc6809_irq);
-  memcpy(buffer+offset, &dc6809_firq, sizeof(dc6809_firq));
-  offset += sizeof(dc6809_firq);
-  memcpy(buffer+offset, &dc6809_nmi, sizeof(dc6809_nmi));
-  offset += sizeof(dc6809_nmi);
-  memcpy(buffer+offset, &dc6809_w, sizeof(dc6809_w));
-  offset += sizeof(dc6809_w);
-  memcpy(buffer+offset, &dc6809_cc, sizeof(dc6809_cc));
-  offset += sizeof(dc6809_cc);
-  memcpy(buffer+offset, &dc6809_pc, sizeof(dc6809_pc));
-  offset += sizeof(dc6809_pc);
-  memcpy(buffer+offset, &dc6809_d, sizeof(dc6809_d));
-  offset += sizeof(dc6809_d);
-  memcpy(buffer+offset, &dc6809_x, sizeof(dc6809_x));
-  offset += sizeof(dc6809_x);
-  memcpy(buffer+offset, &dc6809_y, sizeof(dc6809_y));
-  offset += sizeof(dc6809_y);
-  memcpy(buffer+offset, &dc6809_u, sizeof(dc6809_u));
-  offset += sizeof(dc6809_u);
-  memcpy(buffer+offset, &dc6809_s, sizeof(dc6809_s));
-  offset += sizeof(dc6809_s);
-  memcpy(buffer+offset, &dc6809_da, sizeof(dc6809_da));
+  CpuState state;
+  memset(&state, 0, sizeof(state));
+  state.cycles = dc6809_cycles;
+  state.sync = dc6809_sync;
+  state.irq = dc6809_irq;
+  state.firq = dc6809_firq;
+  state.nmi = dc6809_nmi;
+  state.w = dc6809_w;
+  state.cc = dc6809_cc;
+  state.pc = dc6809_pc;
+  state.d = dc6809_d;
+  state.x = dc6809_x;
+  state.y = dc6809_y;
+  state.u = dc6809_u;
+  state.s = dc6809_s;
+  state.da = dc6809_da;
+  memcpy(data, &state, sizeof(state));
 }
 
 void cpu_unserialize(const void *data)
 {
-  int offset = 0;
-  const char *buffer = (const char *) data;
-  memcpy(&dc6809_cycles, buffer+offset, sizeof(dc6809_cycles));
-  offset += sizeof(dc6809_cycles);
-  memcpy(&dc6809_sync, buffer+offset, sizeof(dc6809_sync));
-  offset += sizeof(dc6809_sync);
-  memcpy(&dc6809_irq, buffer+offset, sizeof(dc6809_irq));
-  offset += sizeof(dc6809_irq);
-  memcpy(&dc6809_firq, buffer+offset, sizeof(dc6809_firq));
-  offset += sizeof(dc6809_firq);
-  memcpy(&dc6809_nmi, buffer+offset, sizeof(dc6809_nmi));
-  offset += sizeof(dc6809_nmi);
-  memcpy(&dc6809_w, buffer+offset, sizeof(dc6809_w));
-  offset += sizeof(dc6809_w);
-  memcpy(&dc6809_cc, buffer+offset, sizeof(dc6809_cc));
-  offset += sizeof(dc6809_cc);
-  memcpy(&dc6809_pc, buffer+offset, sizeof(dc6809_pc));
-  offset += sizeof(dc6809_pc);
-  memcpy(&dc6809_d, buffer+offset, sizeof(dc6809_d));
-  offset += sizeof(dc6809_d);
-  memcpy(&dc6809_x, buffer+offset, sizeof(dc6809_x));
-  offset += sizeof(dc6809_x);
-  memcpy(&dc6809_y, buffer+offset, sizeof(dc6809_y));
-  offset += sizeof(dc6809_y);
-  memcpy(&dc6809_u, buffer+offset, sizeof(dc6809_u));
-  offset += sizeof(dc6809_u);
-  memcpy(&dc6809_s, buffer+offset, sizeof(dc6809_s));
-  offset += sizeof(dc6809_s);
-  memcpy(&dc6809_da, buffer+offset, sizeof(dc6809_da));
+  CpuState state;
+  memcpy(&state, data, sizeof(state));
+  dc6809_cycles = state.cycles;
+  dc6809_sync = state.sync;
+  dc6809_irq = state.irq;
+  dc6809_firq = state.firq;
+  dc6809_nmi = state.nmi;
+  dc6809_w = state.w;
+  dc6809_cc = state.cc;
+  dc6809_pc = state.pc;
+  dc6809_d = state.d;
+  dc6809_x = state.x;
+  dc6809_y = state.y;
+  dc6809_u = state.u;
+  dc6809_s = state.s;
+  dc6809_da = state.da;
 }
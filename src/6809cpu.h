@@ -22,38 +22,40 @@
 #ifndef __6809CPU_H
 #define __6809CPU_H
 
+#include "machine.h"
+
 //pointeurs vers fonctions d'acces memoire
-extern char (*Mgetc)(unsigned short a);
-extern void (*Mputc)(unsigned short a, char c);
+#define Mgetc (machine->cpu.mgetc)
+#define Mputc (machine->cpu.mputc)
 
 // function to read 2 bytes from address
 extern short Mgetw(unsigned short a);
 // function to write 2 bytes at an address
 extern void Mputw(unsigned short a, short w);
 
-//6809 registers
+//6809 registers of the current machine
 //condition code
-extern char  dc6809_cc;
+#define dc6809_cc (machine->cpu.cc)
 //X register
-extern short dc6809_x;
+#define dc6809_x (machine->cpu.x)
 //Y register
-extern short dc6809_y;
+#define dc6809_y (machine->cpu.y)
 //U register
-extern short dc6809_u;
+#define dc6809_u (machine->cpu.u)
 //S register
-extern short dc6809_s;
+#define dc6809_s (machine->cpu.s)
 //Program Counter
-extern unsigned short dc6809_pc;
+#define dc6809_pc (machine->cpu.pc)
 
 //pointer to A register
-extern char *dc6809_a;
+#define dc6809_a (machine->cpu.a)
 //pointer to B register
-extern char *dc6809_b;
+#define dc6809_b (machine->cpu.b)
 //pointer to DP register
-extern char *dc6809_dp;
+#define dc6809_dp (machine->cpu.dp)
 
 //irq trigger  (0=disabled, 1=enabled)
-extern int dc6809_irq;
+#define dc6809_irq (machine->cpu.irq)
 //interrupt request
 extern int Irq(void);
 
@@ -0,0 +1,173 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Audio output of the emulator.
+ * The level changes of the DAC are recorded with their cycle timestamp
+ * during the frame, then synthesized at the end of the frame as band-limited
+ * steps (BLEP) in a buffer of deltas, which is integrated into samples. */
+
+#include <string.h>
+#include "audio.h"
+#include "machine.h"
+
+// Nb of phases (position of the step between two samples) of the kernel
+#define BLEP_PHASES 32
+#define BLEP_PHASE_BITS 5
+// The sum of the kernel values of a phase is 2^BLEP_SHIFT
+#define BLEP_SHIFT 12
+
+// Band-limited impulses (sinc with a cutoff at 90% of the Nyquist frequency,
+// Blackman window) for each phase of the step between two samples
+static const short blepkernel[BLEP_PHASES][BLEP_TAPS] = {
+  {     2,   -14,    45,  -105,   195,  -296,   378,  3686,   378,  -296,   195,  -105,    45,   -14,     2,     0 },
+  {     2,   -14,    43,   -99,   178,  -253,   265,  3681,   497,  -339,   212,  -111,    46,   -14,     2,     0 },
+  {     2,   -13,    41,   -93,   160,  -210,   157,  3667,   620,  -381,   227,  -116,    47,   -14,     2,     0 },
+  {     2,   -13,    39,   -86,   141,  -167,    54,  3642,   748,  -422,   242,  -120,    48,   -14,     2,     0 },
+  {     2,   -12,    37,   -78,   122,  -125,   -42,  3607,   879,  -462,   254,  -123,    48,   -13,     2,     0 },
+  {     2,   -12,    35,   -71,   103,   -83,  -132,  3563,  1013,  -499,   266,  -125,    47,   -13,     2,     0 },
+  {     2,   -11,    32,   -63,    84,   -43,  -215,  3508,  1150,  -534,   276,  -126,    46,   -12,     2,     0 },
+  {     2,   -10,    29,   -55,    65,    -4,  -292,  3445,  1290,  -566,   283,  -126,    45,   -11,     1,     0 },
+  {     1,    -9,    26,   -47,    47,    33,  -361,  3374,  1430,  -596,   289,  -125,    43,   -10,     1,     0 },
+  {     1,    -9,    24,   -39,    29,    68,  -424,  3293,  1572,  -621,   292,  -123,    41,    -9,     1,     0 },
+  {     1,    -8,    21,   -31,    11,   101,  -480,  3206,  1714,  -643,   294,  -120,    38,    -8,     0,     0 },
+  {     1,    -7,    18,   -23,    -5,   131,  -529,  3109,  1856,  -660,   292,  -116,    35,    -6,     0,     0 },
+  {     1,    -6,    15,   -16,   -21,   160,  -571,  3007,  1996,  -673,   288,  -110,    31,    -4,    -1,     0 },
+  {     1,    -5,    12,    -8,   -36,   185,  -606,  2897,  2135,  -681,   282,  -103,    27,    -3,    -1,     0 },
+  {     1,    -5,     9,    -1,   -50,   208,  -634,  2781,  2272,  -683,   273,   -95,    22,     0,    -2,     0 },
+  {     1,    -4,     7,     5,   -63,   229,  -656,  2660,  2405,  -680,   261,   -86,    17,     2,    -2,     0 },
+  {     0,    -3,     4,    11,   -75,   246,  -671,  2537,  2535,  -671,   246,   -75,    11,     4,    -3,     0 },
+  {     0,    -2,     2,    17,   -86,   261,  -680,  2405,  2660,  -656,   229,   -63,     5,     7,    -4,     1 },
+  {     0,    -2,     0,    22,   -95,   273,  -683,  2272,  2781,  -634,   208,   -50,    -1,     9,    -5,     1 },
+  {     0,    -1,    -3,    27,  -103,   282,  -681,  2135,  2897,  -606,   185,   -36,    -8,    12,    -5,     1 },
+  {     0,    -1,    -4,    31,  -110,   288,  -673,  1996,  3007,  -571,   160,   -21,   -16,    15,    -6,     1 },
+  {     0,     0,    -6,    35,  -116,   292,  -660,  1856,  3109,  -529,   131,    -5,   -23,    18,    -7,     1 },
+  {     0,     0,    -8,    38,  -120,   294,  -643,  1714,  3206,  -480,   101,    11,   -31,    21,    -8,     1 },
+  {     0,     1,    -9,    41,  -123,   292,  -621,  1572,  3293,  -424,    68,    29,   -39,    24,    -9,     1 },
+  {     0,     1,   -10,    43,  -125,   289,  -596,  1430,  3374,  -361,    33,    47,   -47,    26,    -9,     1 },
+  {     0,     1,   -11,    45,  -126,   283,  -566,  1290,  3445,  -292,    -4,    65,   -55,    29,   -10,     2 },
+  {     0,     2,   -12,    46,  -126,   276,  -534,  1150,  3508,  -215,   -43,    84,   -63,    32,   -11,     2 },
+  {     0,     2,   -13,    47,  -125,   266,  -499,  1013,  3563,  -132,   -83,   103,   -71,    35,   -12,     2 },
+  {     0,     2,   -13,    48,  -123,   254,  -462,   879,  3607,   -42,  -125,   122,   -78,    37,   -12,     2 },
+  {     0,     2,   -14,    48,  -120,   242,  -422,   748,  3642,    54,  -167,   141,   -86,    39,   -13,     2 },
+  {     0,     2,   -14,    47,  -116,   227,  -381,   620,  3667,   157,  -210,   160,   -93,    41,   -13,     2 },
+  {     0,     2,   -14,    46,  -111,   212,  -339,   497,  3681,   265,  -253,   178,   -99,    43,   -14,     2 },
+};
+
+// Sortie audio de la machine courante
+#define events (machine->audio.events)                   //changements de niveau de la trame
+#define cpufrequency (machine->audio.cpufrequency)       //frequence du processeur emule (Hz)
+#define nevents (machine->audio.nevents)                 //nombre de changements enregistres
+#define eventlevel (machine->audio.eventlevel)           //niveau apres le dernier changement enregistre
+#define synthlevel (machine->audio.synthlevel)           //niveau apres le dernier changement synthetise
+#define deltas (machine->audio.deltas)                   //variations du niveau pour chaque echantillon
+#define integrator (machine->audio.integrator)           //niveau de sortie (x 2^BLEP_SHIFT)
+#define samplespercycle (machine->audio.samplespercycle) //nombre d'echantillons par cycle (virgule fixe 32.32)
+#define frametime (machine->audio.frametime)             //position du debut de la trame entre deux echantillons (32.32)
+
+void InitAudio(int cpu_frequency, int sample_rate)
+{
+  cpufrequency = cpu_frequency;
+  nevents = 0;
+  eventlevel = synthlevel = 0;
+  integrator = 0;
+  memset(deltas, 0, sizeof(deltas));
+  SetAudioSampleRate(sample_rate);
+}
+
+void SetAudioSampleRate(int sample_rate)
+{
+  int i;
+  // The steps already synthesized at the previous rate are completed at once
+  for (i = 0; i < DELTA_BUFFER_SIZE; i++)
+  {
+    integrator += deltas[i];
+  }
+  memset(deltas, 0, sizeof(deltas));
+  frametime = 0;
+  // Rounded up so that a frame never produces less samples than expected
+  samplespercycle = (((uint64_t) sample_rate << 32) + cpufrequency - 1) / cpufrequency;
+}
+
+// Synthesis of the recorded level changes in the buffer of deltas
+static void Flushevents(void)
+{
+  int i, k, n, phase, delta;
+  uint64_t t;
+  const short *kernel;
+  int32_t *d;
+  for (i = 0; i < nevents; i++)
+  {
+    t = frametime + events[i].cycle * samplespercycle;
+    n = (int) (t >> 32);
+    if (n >= AUDIO_MAX_SAMPLES_PER_FRAME) n = AUDIO_MAX_SAMPLES_PER_FRAME - 1;
+    phase = (int) (t >> (32 - BLEP_PHASE_BITS)) & (BLEP_PHASES - 1);
+    delta = events[i].level - synthlevel;
+    synthlevel = events[i].level;
+    kernel = blepkernel[phase];
+    d = deltas + n;
+    for (k = 0; k < BLEP_TAPS; k++)
+    {
+      d[k] += delta * kernel[k];
+    }
+  }
+  nevents = 0;
+}
+
+void AudioLevel(int cycle, int16_t level)
+{
+  if (level == eventlevel)
+  {
+    return;
+  }
+  if (nevents == MAX_AUDIO_EVENTS)
+  {
+    Flushevents();
+  }
+  events[nevents].cycle = cycle;
+  events[nevents].level = level;
+  nevents++;
+  eventlevel = level;
+}
+
+int AudioEndFrame(int cycles, int16_t *buffer)
+{
+  int i, nsamples;
+  int32_t sample;
+  uint64_t end = frametime + cycles * samplespercycle;
+  Flushevents();
+  nsamples = (int) (end >> 32);
+  if (nsamples > AUDIO_MAX_SAMPLES_PER_FRAME) nsamples = AUDIO_MAX_SAMPLES_PER_FRAME;
+  // Integration of the deltas
+  for (i = 0; i < nsamples; i++)
+  {
+    integrator += deltas[i];
+    if (buffer != NULL)
+    {
+      sample = integrator >> BLEP_SHIFT;
+      if (sample > 32767) sample = 32767;
+      if (sample < -32768) sample = -32768;
+      buffer[(i << 1) + 0] = buffer[(i << 1) + 1] = (int16_t) sample;
+    }
+  }
+  // The end of the steps of the frame goes to the next frame
+  memmove(deltas, deltas + nsamples, BLEP_TAPS * sizeof(int32_t));
+  memset(deltas + BLEP_TAPS, 0, nsamples * sizeof(int32_t));
+  frametime = end & 0xffffffff;
+  return nsamples;
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Audio output of the emulator */
+
+#ifndef __AUDIO_H
+#define __AUDIO_H
+
+#include <stdint.h>
+
+// Max number of samples produced for one frame
+#define AUDIO_MAX_SAMPLES_PER_FRAME 2048
+
+// Initialisation of the audio output
+// (frequency of the emulated CPU and sample rate of the output, in Hz)
+void InitAudio(int cpu_frequency, int sample_rate);
+// Changes the sample rate of the output (in Hz)
+void SetAudioSampleRate(int sample_rate);
+// Changes the output level of the DAC at the given cycle of the current frame
+void AudioLevel(int cycle, int16_t level);
+// Ends the current frame, which lasted the given number of cycles:
+// synthesizes its stereo samples into buffer (if not NULL) and returns their number
+int AudioEndFrame(int cycles, int16_t *buffer);
+
+#endif /* __AUDIO_H */
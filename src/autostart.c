@@ -27,9 +27,13 @@
 #include <ctype.h>
 
 #include "autostartkeys.h"
+#include "basic.h"
+#include "binary.h"
+#include "dosdir.h"
 #include "logger.h"
 #include "keymap.h"
 #include "motoemulator.h"
+#include "paste.h"
 
 #define SIZE_BUFFER_TAPE 32
 #define TAPE_BASIC_PATTERN1 "BAS\0"
@@ -38,12 +42,18 @@
 #define TAPE_BASIC_PATTERN2_SIZE 10
 #define TAPE_BASIC_PATTERN3 "ENTETE  TO"
 #define TAPE_BASIC_PATTERN3_SIZE 10
-
-static const Key *autostart_keys = NULL;
-static int current_autostart_key_pos = -1;
+#define FLOPPY_AUTORUN_FILE "AUTO.BAT"
+#define FLOPPY_COMMAND_LENGTH (DOS_NAME_LENGTH + 16)
 
 static Media currentMedia = NO_MEDIA;
 static bool program_is_basic = true;
+// Command typed to start the program of a floppy (empty if the disk has no DOS directory)
+static char floppy_command[FLOPPY_COMMAND_LENGTH];
+// True if the floppy has a file run at the start of BASIC 512 and BASIC 128
+static bool floppy_has_autorun = false;
+// The start command of a floppy is typed once BASIC, selected in the menu, waits for a command
+typedef enum { FLOPPY_COMMAND_NONE, FLOPPY_COMMAND_IN_MENU, FLOPPY_COMMAND_IN_BASIC } FloppyCommandStep;
+static FloppyCommandStep floppy_command_step = FLOPPY_COMMAND_NONE;
 #define MD5_LENGTH 16
 #define MD5_BUFFER_SIZE 1024
 static unsigned char md5_digest[MD5_LENGTH];
@@ -88,6 +98,14 @@ Media get_media_type(const char *filename)
   {
     return MEDIA_CARTRIDGE;
   }
+  else if (strlen(filename) > 4 && streq_nocase(filename + strlen(filename) - 4, ".bas"))
+  {
+    return MEDIA_BASIC;
+  }
+  else if (strlen(filename) > 4 && streq_nocase(filename + strlen(filename) - 4, ".bin"))
+  {
+    return MEDIA_BINARY;
+  }
   else
   {
     return NO_MEDIA;
@@ -215,11 +233,55 @@ static void compute_md5(const char *filename, unsigned char *hash)
   MD5_Final(hash, &ctx);
 }
 
+/* Chooses the command that starts a floppy from the files of its directory:
+   AUTO.BAT if there is one, else the first BASIC program, else the first
+   binary program. */
+static void autodetect_floppy_command(const char *filename)
+{
+  DosDirectory dir;
+  int i;
+  floppy_command[0] = '\0';
+  floppy_has_autorun = false;
+  if (!ReadDosDirectory(filename, 0, &dir))
+  {
+    LOG_DEBUG("No DOS directory found on floppy %s.\n", filename);
+    return;
+  }
+  if (FindDosFile(&dir, FLOPPY_AUTORUN_FILE) != NULL)
+  {
+    floppy_has_autorun = true;
+    snprintf(floppy_command, FLOPPY_COMMAND_LENGTH, "RUN\"%s\"\r", FLOPPY_AUTORUN_FILE);
+  }
+  for (i = 0; (i < dir.nfiles) && (floppy_command[0] == '\0'); i++)
+  {
+    if (dir.files[i].type == DOS_FILE_BASIC)
+    {
+      snprintf(floppy_command, FLOPPY_COMMAND_LENGTH, "RUN\"%s\"\r", dir.files[i].name);
+    }
+  }
+  for (i = 0; (i < dir.nfiles) && (floppy_command[0] == '\0'); i++)
+  {
+    if ((dir.files[i].type == DOS_FILE_BINARY) && !dir.files[i].ascii)
+    {
+      snprintf(floppy_command, FLOPPY_COMMAND_LENGTH, "LOADM\"%s\",,R\r", dir.files[i].name);
+    }
+  }
+  LOG_DEBUG("Floppy %s: %d files, start command: %s\n", filename, dir.nfiles, floppy_command);
+}
+
 void autostart_init(const char *filename, bool compute_hash)
 {
   currentMedia = get_media_type(filename);
   program_is_basic = autodetect_tape_first_file_is_basic(filename);
-  current_autostart_key_pos = -1;
+  floppy_command_step = FLOPPY_COMMAND_NONE;
+  if (currentMedia == MEDIA_FLOPPY)
+  {
+    autodetect_floppy_command(filename);
+  }
+  else
+  {
+    floppy_command[0] = '\0';
+  }
   memset(md5_digest, 0, sizeof(md5_digest));
   if (compute_hash)
   {
@@ -233,9 +295,70 @@ void autostart_init(const char *filename, bool compute_hash)
   }
 }
 
+/* Keys to select BASIC 1 in the menu of the computer. */
+static const Key* get_basic1_keys(ThomsonModel model)
+{
+  switch (model)
+  {
+    case MO5:
+      return NO_AUTOSTART_KEYS;
+    case MO6:
+    case PC128:
+      return BASIC1_MO6_MENU_KEYS;
+    case TO7:
+    case TO7_70:
+      return BASIC1_TO7_MENU_KEYS;
+    case TO9:
+      return BASIC1_TO9_MENU_KEYS;
+    default:
+      return BASIC1_TO8_MENU_KEYS;
+  }
+}
+
+/* Keys to select the BASIC that types the start command of a floppy: BASIC 512
+ * on TO8/TO8D/TO9+ and BASIC 128 on TO9 (they run AUTO.BAT by themselves),
+ * BASIC 1 on the other models. */
+static const Key* get_floppy_basic_keys(ThomsonModel model)
+{
+  switch (model)
+  {
+    case TO8:
+    case TO8D:
+    case TO9P:
+      return BASIC512_KEYS;
+    case TO9:
+      return BASIC128_KEYS;
+    default:
+      return get_basic1_keys(model);
+  }
+}
+
+/* Returns true if the start command of the floppy must be typed once BASIC is selected. */
+static bool is_floppy_command_typed(ThomsonModel model)
+{
+  // BASIC 512 and BASIC 128 run AUTO.BAT by themselves
+  bool autorun = (model == TO8) || (model == TO8D) || (model == TO9) || (model == TO9P);
+  return (floppy_command[0] != '\0') && !(floppy_has_autorun && autorun);
+}
+
 static const Key* get_default_autostart_keys(ThomsonModel model, Media media)
 {
   const Key* keys = NULL;
+  // A floppy with a DOS directory is started by a command chosen from its files
+  if ((media == MEDIA_FLOPPY) && (floppy_command[0] != '\0'))
+  {
+    return get_floppy_basic_keys(model);
+  }
+  // A BASIC listing is written in memory and run by basic.c once BASIC 1 is started
+  if (media == MEDIA_BASIC)
+  {
+    return get_basic1_keys(model);
+  }
+  // A binary program is copied in memory and started by binary.c
+  if (media == MEDIA_BINARY)
+  {
+    return NO_AUTOSTART_KEYS;
+  }
   switch (model)
     {
       case MO5:
@@ -277,6 +400,7 @@ static const Key* get_default_autostart_keys(ThomsonModel model, Media media)
         }
         break;
       case TO7:
+      case TO7_70:
         if (media == MEDIA_CARTRIDGE)
         {
           keys = TO7_CARTRIDGE_AUTOSTART_KEYS;
@@ -290,20 +414,6 @@ static const Key* get_default_autostart_keys(ThomsonModel model, Media media)
           keys = TO7_AUTOSTART_BIN_KEYS;
         }
         break;
-      case TO7_70:
-        if (media == MEDIA_CARTRIDGE)
-        {
-          keys = TO7_CARTRIDGE_AUTOSTART_KEYS;
-        }
-        else if (program_is_basic)
-        {
-          keys = TO770_AUTOSTART_BASIC_KEYS;
-        }
-        else
-        {
-          keys = TO770_AUTOSTART_BIN_KEYS;
-        }
-        break;
       // Most games are started with the 'B' key (Basic 512) on TO8/TO8D/TO9+
       // and the 'D' key (Basic 128) on TO9.
       // Tapes generally requires BASIC 1 ('C' key on TO8/TO8D/TO9+, 'E' key on TO9).
@@ -375,35 +485,76 @@ static bool is_hash_computed()
   return false;
 }
 
-bool autostart_nextkey()
+void autostart_typekeys()
 {
-  // First key?
-  if (current_autostart_key_pos < 0)
-  {
-    ThomsonModel model = GetThomsonModel();
-    current_autostart_key_pos = 0;
-    // First search if it is a known game with a specific start method, and
-    // if not use the default start method
-    autostart_keys = NULL;
-    if (is_hash_computed())
+  ThomsonModel model = GetThomsonModel();
+  const Key* keys = NULL;
+  bool default_keys = false;
+  int i;
+  // First search if it is a known game with a specific start method, and
+  // if not use the default start method
+  if (is_hash_computed())
+  {
+    keys = find_specific_autostart_keys(model);
+  }
+  if (keys == NULL)
+  {
+    keys = get_default_autostart_keys(model, currentMedia);
+    default_keys = true;
+  }
+  // The emulator applies each key when the previous one has been read
+  for (i = 0; keys[i].retrokey != RETROK_UNKNOWN; i++)
+  {
+    TypeKeyboard(libretroKeyCodeToThomsonScanCode[keys[i].retrokey], keys[i].down);
+  }
+  // The start command of a floppy is typed after the keys selecting BASIC 1, which
+  // starts at once, or when BASIC 512/128 is ready (see autostart_update)
+  if (default_keys && (currentMedia == MEDIA_FLOPPY) && is_floppy_command_typed(model))
+  {
+    if (keys == get_basic1_keys(model))
     {
-      autostart_keys = find_specific_autostart_keys(model);
+      PasteText(floppy_command);
     }
-    if (autostart_keys == NULL)
+    else
     {
-      autostart_keys = get_default_autostart_keys(model, currentMedia);
+      floppy_command_step = FLOPPY_COMMAND_IN_MENU;
     }
   }
+  if (currentMedia == MEDIA_BASIC)
+  {
+    RunBasic();
+  }
+  else if (currentMedia == MEDIA_BINARY)
+  {
+    RunBinary();
+  }
+}
 
-  // No more keys?
-  if (autostart_keys[current_autostart_key_pos].retrokey == RETROK_UNKNOWN)
+void autostart_update()
+{
+  switch (floppy_command_step)
   {
-    current_autostart_key_pos = -1;
-    return false;
+    // The menu is left once the key selecting BASIC has been read
+    case FLOPPY_COMMAND_IN_MENU:
+      if (!IsTyping() && !IsWaitingForKey())
+      {
+        floppy_command_step = FLOPPY_COMMAND_IN_BASIC;
+      }
+      break;
+    // The keys typed while BASIC starts would be lost
+    case FLOPPY_COMMAND_IN_BASIC:
+      if (IsWaitingForKey())
+      {
+        floppy_command_step = FLOPPY_COMMAND_NONE;
+        PasteText(floppy_command);
+      }
+      break;
+    default:
+      break;
   }
+}
 
-  keyboard(libretroKeyCodeToThomsonScanCode[autostart_keys[current_autostart_key_pos].retrokey],
-           autostart_keys[current_autostart_key_pos].down);
-  current_autostart_key_pos++;
-  return true;
+void autostart_stop()
+{
+  floppy_command_step = FLOPPY_COMMAND_NONE;
 }
@@ -24,7 +24,7 @@
 #include "boolean.h"
 
 /* Kind of media inserted. */
-typedef enum { NO_MEDIA, MEDIA_FLOPPY, MEDIA_TAPE, MEDIA_CARTRIDGE } Media;
+typedef enum { NO_MEDIA, MEDIA_FLOPPY, MEDIA_TAPE, MEDIA_CARTRIDGE, MEDIA_BASIC, MEDIA_BINARY } Media;
 
 /* Returns the kind of media represented by the given filename. */
 Media get_media_type(const char *filename);
@@ -37,8 +37,13 @@ char *autodetect_model(const char *filename);
 /* Initialise the autostart feature.
  * This function must be called when a file/game is loaded. */
 void autostart_init(const char *filename, bool compute_hash);
-/* This function must be called once per call of input_poll_cb() until it returns false
- * to simulate the keystrokes needed to start the currently loaded media. */
-bool autostart_nextkey();
+/* Types the keystrokes needed to start the currently loaded media
+ * (they are applied by the emulator at the pace of the emulated computer). */
+void autostart_typekeys();
+/* Types the start command of a floppy once BASIC is ready.
+ * This function must be called at each frame. */
+void autostart_update();
+/* Cancels the start command of a floppy that has not been typed yet. */
+void autostart_stop();
 
 #endif /* __AUTOSTART_H */
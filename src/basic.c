@@ -0,0 +1,436 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Direct loading of BASIC programs (listings in text files).
+ * The lines of the listing are tokenized with the keywords of the BASIC 1
+ * (Microsoft) of the model, the same way as the interpreter does when they
+ * are typed, and written in its program area: each line is stored as
+ * [address of the next line][line number][tokens][0], and the program ends
+ * with a null address. The pointers of the end of the program are then
+ * updated and RUN is typed. BASIC 128/512 store the program in a RAM bank
+ * with another format and are not supported. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <streams/file_stream.h>
+#include "basic.h"
+#include "6809cpu.h"
+#include "logger.h"
+#include "motoemulator.h"
+#include "paste.h"
+
+#define MAX_LINE_NUMBER 63999
+// Max size of a tokenized line (size of the input buffer of BASIC)
+#define MAX_LINE_SIZE   250
+// Number of frames BASIC must wait for a command before the program is written
+#define READY_FRAMES    25
+
+#define TOKEN_DATA      0x83
+#define TOKEN_REM       0x8c
+#define TOKEN_QUOTE     0x8d
+#define TOKEN_PRINT     0xab
+#define TOKEN_WHILE     0xaf
+#define TOKEN_WEND      0xb0
+#define TOKEN_FUNCTION  0xff
+
+// Instructions du BASIC 1 MO5, MO6 et PC128 (tokens 0x80 a 0xd5)
+static const char *const mostatements[] =
+{
+  "END", "FOR", "NEXT", "DATA", "DIM", "READ", NULL, "GO", "RUN", "IF", "RESTORE", "RETURN", "REM",
+  "'", "STOP", "ELSE", "TRON", "TROFF", "DEFSTR", "DEFINT", "DEFSNG", NULL, "ON", "TUNE", "ERROR",
+  "RESUME", "AUTO", "DELETE", "LOCATE", "CLS", "CONSOLE", "PSET", "MOTOR", "SKIPF", "EXEC", "BEEP",
+  "COLOR", "LINE", "BOX", NULL, "ATTRB", "DEF", "POKE", "PRINT", "CONT", "LIST", "CLEAR", "DOS",
+  NULL, "NEW", "SAVE", "LOAD", "MERGE", "OPEN", "CLOSE", "INPEN", "PEN", "PLAY", "TAB(", "TO",
+  "SUB", "FN", "SPC(", "USING", "USR", "ERL", "ERR", "OFF", "THEN", "NOT", "STEP", "+", "-", "*",
+  "/", "^", "AND", "OR", "XOR", "EQV", "IMP", "MOD", "@", ">", "=", "<"
+};
+
+// Fonctions du BASIC 1 MO5, MO6 et PC128 (tokens 0xff 0x80 a 0xff 0xa6)
+static const char *const mofunctions[] =
+{
+  "SGN", "INT", "ABS", "FRE", "SQR", "LOG", "EXP", "COS", "SIN", "TAN", "PEEK", "LEN", "STR$",
+  "VAL", "ASC", "CHR$", "EOF", "CINT", NULL, NULL, "FIX", "HEX$", NULL, "STICK", "STRIG", "GR$",
+  "LEFT$", "RIGHT$", "MID$", "INSTR", "VARPTR", "RND", "INKEY$", "INPUT", "CSRLIN", "POINT",
+  "SCREEN", "POS", "PTRIG"
+};
+
+// Instructions du BASIC 1 TO (tokens 0x80 a 0xd5)
+static const char *const tostatements[] =
+{
+  "END", "FOR", "NEXT", "DATA", "DIM", "READ", "LET", "GO", "RUN", "IF", "RESTORE", "RETURN",
+  "REM", "'", "STOP", "ELSE", "TRON", "TROFF", "DEFSTR", "DEFINT", "DEFSNG", "DEFDBL", "ON",
+  "WAIT", "ERROR", "RESUME", "AUTO", "DELETE", "LOCATE", "CLS", "CONSOLE", "PSET", "MOTOR",
+  "SKIPF", "EXEC", "BEEP", "COLOR", "LINE", "BOX", "UNMASK", "ATTRB", "DEF", "POKE", "PRINT",
+  "CONT", "LIST", "CLEAR", "WHILE", "WEND", "NEW", "SAVE", "LOAD", "MERGE", "OPEN", "CLOSE",
+  "INPEN", "PEN", "PLAY", "TAB(", "TO", "SUB", "FN", "SPC(", "USING", "USR", "ERL", "ERR", "OFF",
+  "THEN", "NOT", "STEP", "+", "-", "*", "/", "^", "AND", "OR", "XOR", "EQV", "IMP", "MOD", "@",
+  ">", "=", "<"
+};
+
+// Fonctions du BASIC 1 TO (tokens 0xff 0x80 a 0xff 0xa6)
+static const char *const tofunctions[] =
+{
+  "SGN", "INT", "ABS", "FRE", "SQR", "LOG", "EXP", "COS", "SIN", "TAN", "PEEK", "LEN", "STR$",
+  "VAL", "ASC", "CHR$", "EOF", "CINT", "CSNG", "CDBL", "FIX", "HEX$", "OCT$", "STICK", "STRIG",
+  "GR$", "LEFT$", "RIGHT$", "MID$", "INSTR", "VARPTR", "RND", "INKEY$", "INPUT", "CSRLIN", "POINT",
+  "SCREEN", "POS", "PTRIG"
+};
+
+typedef struct
+{
+  const char *const *statements;
+  int nstatements;
+  const char *const *functions;
+  int nfunctions;
+  int pointers;   // Address of the pointer of the beginning of the program, followed
+                  // by the pointers of its end and by the pointer of the top of memory
+  int nendpointers;
+  bool colonendsdata;   // DATA ends at the next ':' (TO) or at the end of the line (MO)
+} Basic;
+
+static const Basic basicmo = { mostatements, sizeof(mostatements) / sizeof(mostatements[0]),
+  mofunctions, sizeof(mofunctions) / sizeof(mofunctions[0]), 0x2113, 2, false };
+static const Basic basicto = { tostatements, sizeof(tostatements) / sizeof(tostatements[0]),
+  tofunctions, sizeof(tofunctions) / sizeof(tofunctions[0]), 0x611c, 3, true };
+
+typedef struct
+{
+  unsigned int number;  // Line number
+  int order;            // Position of the line in the listing
+  size_t offset;        // Position of the tokens in the buffer
+  int size;             // Number of bytes of the tokens
+} BasicLine;
+
+static char *listing = NULL;        //texte du programme (termine par un zero)
+static bool runrequested = false;   //programme a charger des que BASIC est pret
+static int readyframes = 0;         //nombre de trames ou BASIC est pret
+
+static const Basic *current_basic(void)
+{
+  switch (GetThomsonModel())
+  {
+    case MO5:
+    case MO6:
+    case PC128:
+      return &basicmo;
+    default:
+      return &basicto;
+  }
+}
+
+static int peekw(int address)
+{
+  return ((Mgetc(address) & 0xff) << 8) | (Mgetc(address + 1) & 0xff);
+}
+
+static void pokew(int address, int value)
+{
+  Mputc(address, (value >> 8) & 0xff);
+  Mputc(address + 1, value & 0xff);
+}
+
+// Returns the length of the keyword if the text begins with it (case insensitive), 0 otherwise
+static int match_keyword(const char *text, const char *keyword)
+{
+  int i;
+  for (i = 0; keyword[i] != '\0'; i++)
+  {
+    if (toupper((unsigned char) text[i]) != keyword[i])
+    {
+      return 0;
+    }
+  }
+  return i;
+}
+
+// Searches the first keyword of the table the text begins with.
+// Returns its index in the table (-1 if none) and its length.
+static int find_keyword(const char *text, const char *const *keywords, int nkeywords, int *length)
+{
+  int i;
+  for (i = 0; i < nkeywords; i++)
+  {
+    if ((keywords[i] != NULL) && ((*length = match_keyword(text, keywords[i])) > 0))
+    {
+      // WHILE et WEND n'existent pas dans le BASIC 1 des TO8, TO9 et TO9+
+      if ((keywords == tostatements) && ((i + 0x80 == TOKEN_WHILE) || (i + 0x80 == TOKEN_WEND))
+          && (GetThomsonModel() != TO7) && (GetThomsonModel() != TO7_70))
+      {
+        continue;
+      }
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Tokenizes a line (text after the line number, up to the end of line) as BASIC does:
+// strings, comments and DATA are kept as is, and the keywords are not searched
+// in the names of the variables. Returns the number of bytes of the tokens.
+static int tokenize_line(const Basic *basic, const char *text, unsigned char *tokens)
+{
+  int size = 0, index, length;
+  bool quoted = false, verbatim = false, data = false, variable = false;
+  while ((*text != '\0') && (*text != '\n') && (*text != '\r') && (size + 2 <= MAX_LINE_SIZE))
+  {
+    unsigned char c = *text;
+    if (c == '\t') c = ' ';
+    // Caracteres non ASCII et de controle ignores
+    if ((c >= 0x80) || (c < 0x20))
+    {
+      text++;
+      continue;
+    }
+    if (data && !quoted && (c == ':'))
+    {
+      data = false;
+    }
+    if (verbatim || quoted || data)
+    {
+      tokens[size++] = c;
+      if (!verbatim && (c == '"')) quoted = !quoted;
+      text++;
+      continue;
+    }
+    if (variable && isalnum(c))
+    {
+      tokens[size++] = toupper(c);
+      text++;
+      continue;
+    }
+    variable = false;
+    if (c == '"')
+    {
+      tokens[size++] = c;
+      quoted = true;
+      text++;
+    }
+    else if (c == '?')
+    {
+      tokens[size++] = TOKEN_PRINT;
+      text++;
+    }
+    else if ((index = find_keyword(text, basic->statements, basic->nstatements, &length)) >= 0)
+    {
+      // Le commentaire ' est stocke comme :'
+      if (index + 0x80 == TOKEN_QUOTE)
+      {
+        tokens[size++] = ':';
+      }
+      tokens[size++] = index + 0x80;
+      verbatim = (index + 0x80 == TOKEN_REM) || (index + 0x80 == TOKEN_QUOTE)
+          || ((index + 0x80 == TOKEN_DATA) && !basic->colonendsdata);
+      data = (index + 0x80 == TOKEN_DATA) && basic->colonendsdata;
+      text += length;
+    }
+    else if ((index = find_keyword(text, basic->functions, basic->nfunctions, &length)) >= 0)
+    {
+      tokens[size++] = TOKEN_FUNCTION;
+      tokens[size++] = index + 0x80;
+      text += length;
+    }
+    else
+    {
+      tokens[size++] = toupper(c);
+      variable = isalpha(c);
+      text++;
+    }
+  }
+  return size;
+}
+
+// Sorts the lines by number, and for a same number in the order of the listing
+static int compare_lines(const void *a, const void *b)
+{
+  const BasicLine *line1 = (const BasicLine *) a;
+  const BasicLine *line2 = (const BasicLine *) b;
+  if (line1->number != line2->number)
+  {
+    return (line1->number < line2->number) ? -1 : 1;
+  }
+  return line1->order - line2->order;
+}
+
+// Tokenizes the listing and writes it at the beginning of the program area of BASIC.
+// Returns false if the program does not fit in memory.
+static bool write_program(const Basic *basic)
+{
+  size_t length = strlen(listing), offset = 0;
+  int nlines = 0, i, address, top;
+  const char *text = listing;
+  unsigned char *tokens;
+  BasicLine *lines;
+  bool fits = true;
+
+  for (i = 0; text[i] != '\0'; i++)
+  {
+    if (text[i] == '\n') nlines++;
+  }
+  // Each character gives at most 2 bytes (' stored as :')
+  tokens = malloc(2 * length + 1);
+  lines = malloc((nlines + 1) * sizeof(BasicLine));
+  nlines = 0;
+  if ((tokens == NULL) || (lines == NULL))
+  {
+    LOG_ERROR("Not enough memory to load the BASIC program.\n");
+    free(tokens);
+    free(lines);
+    return false;
+  }
+  while (*text != '\0')
+  {
+    unsigned int number = 0;
+    while ((*text == ' ') || (*text == '\t')) text++;
+    if (isdigit((unsigned char) *text))
+    {
+      while (isdigit((unsigned char) *text) && (number <= MAX_LINE_NUMBER))
+      {
+        number = number * 10 + (*text++ - '0');
+      }
+      while (*text == ' ') text++;
+      if (number <= MAX_LINE_NUMBER)
+      {
+        lines[nlines].number = number;
+        lines[nlines].order = nlines;
+        lines[nlines].offset = offset;
+        lines[nlines].size = tokenize_line(basic, text, tokens + offset);
+        offset += lines[nlines].size;
+        nlines++;
+      }
+      else
+      {
+        LOG_WARN("Invalid line number in BASIC program.\n");
+      }
+    }
+    else if ((*text != '\n') && (*text != '\r') && (*text != '\0'))
+    {
+      LOG_WARN("Line without number ignored in BASIC program.\n");
+    }
+    while ((*text != '\n') && (*text != '\0')) text++;
+    if (*text == '\n') text++;
+  }
+  qsort(lines, nlines, sizeof(BasicLine), compare_lines);
+
+  // Comme au clavier, une ligne remplace la precedente de meme numero
+  // et un numero seul supprime la ligne
+  address = peekw(basic->pointers);
+  top = peekw(basic->pointers + 2 * (basic->nendpointers + 1));
+  for (i = 0; i < nlines; i++)
+  {
+    int next = address + 2 + 2 + lines[i].size + 1, k;
+    if (((i + 1 < nlines) && (lines[i + 1].number == lines[i].number)) || (lines[i].size == 0))
+    {
+      continue;
+    }
+    if (next + 2 > top)
+    {
+      fits = false;
+      break;
+    }
+    pokew(address, next);
+    pokew(address + 2, lines[i].number);
+    for (k = 0; k < lines[i].size; k++)
+    {
+      Mputc(address + 4 + k, tokens[lines[i].offset + k]);
+    }
+    Mputc(next - 1, 0);
+    address = next;
+  }
+  free(tokens);
+  free(lines);
+  if (!fits)
+  {
+    LOG_ERROR("The BASIC program does not fit in memory.\n");
+    // Programme vide
+    address = peekw(basic->pointers);
+  }
+  pokew(address, 0);
+  for (i = 1; i <= basic->nendpointers; i++)
+  {
+    pokew(basic->pointers + 2 * i, address + 2);
+  }
+  return fits;
+}
+
+// BASIC 1 is ready when it waits for a command with an empty program
+static bool is_basic_ready(const Basic *basic)
+{
+  int start = peekw(basic->pointers);
+  int top = peekw(basic->pointers + 2 * (basic->nendpointers + 1));
+  int i;
+  if (IsTyping() || (start == 0) || (start >= top) || (Mgetc(start - 1) != 0) || (peekw(start) != 0))
+  {
+    return false;
+  }
+  for (i = 1; i <= basic->nendpointers; i++)
+  {
+    if (peekw(basic->pointers + 2 * i) != start + 2)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LoadBasic(const char *filename)
+{
+  void *data = NULL;
+  int64_t size;
+  UnloadBasic();
+  // The data read is terminated by a zero
+  if (!filestream_read_file(filename, &data, &size) || (data == NULL))
+  {
+    LOG_ERROR("Cannot read file %s.\n", filename);
+    return false;
+  }
+  listing = (char *) data;
+  return true;
+}
+
+void UnloadBasic(void)
+{
+  free(listing);
+  listing = NULL;
+  runrequested = false;
+}
+
+void RunBasic(void)
+{
+  runrequested = (listing != NULL);
+  readyframes = 0;
+}
+
+void UpdateBasic(void)
+{
+  const Basic *basic;
+  if (!runrequested) return;
+  basic = current_basic();
+  if (!is_basic_ready(basic))
+  {
+    readyframes = 0;
+    return;
+  }
+  if (++readyframes < READY_FRAMES) return;
+  runrequested = false;
+  if (write_program(basic))
+  {
+    PasteText("RUN\r");
+  }
+}
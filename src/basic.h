@@ -0,0 +1,37 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Direct loading of BASIC programs (listings in text files) */
+
+#ifndef __BASIC_H
+#define __BASIC_H
+
+#include "boolean.h"
+
+// Reads a BASIC listing (text file). Returns false if the file cannot be read.
+bool LoadBasic(const char *filename);
+// Forgets the BASIC listing
+void UnloadBasic(void);
+// Requests to write the listing in the memory of the emulated computer and to run it:
+// this is done as soon as BASIC 1 waits for a command with an empty program.
+void RunBasic(void);
+// To be called at each frame
+void UpdateBasic(void);
+
+#endif /* __BASIC_H */
@@ -0,0 +1,637 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Headless batch runner: emulates a list of jobs (a media image with a model,
+ * a number of frames and an optional input script) without any frontend,
+ * on a pool of worker threads, and writes for each job the last frame (PPM),
+ * the RAM of the model and the emulation time.
+ *
+ * Usage: theodore_batch [-j workers] [-o output_dir] [-d date] [-b frames] [-w] [-l] job_list
+ *
+ * Each line of the job list is "image model frames [script]", where model is
+ * TO8, TO8D, TO9, TO9+, MO5, MO6, PC128, TO7, TO7/70 or Auto (from the name of
+ * the image). Each line of an input script is an event applied at the
+ * beginning of a frame (numbered from 0):
+ *   frame key scancode down   (scancode of the emulated model, down = 0 or 1)
+ *   frame joy axis on         (axis = JoystickAxis value, on = 0 or 1)
+ *   frame pen x y button
+ * Empty lines and lines beginning with '#' are ignored in both files.
+ * The script can also be an input movie (*.tmv) recorded by the libretro core
+ * with the same image: the job is then emulated with the model and the date of
+ * the movie, from a hardreset, and 0 frames means the length of the movie.
+ *
+ * The jobs are shared between the workers, each worker taking its jobs in order
+ * from its own queue, then stealing the last jobs of the other queues.
+ * Each job is emulated in a new machine with the same date written in the ROM,
+ * so that its results do not depend on the worker that ran it. With -b, the
+ * jobs start from a machine of a pool, reset to the state of its model after
+ * the given number of frames of boot (the media is inserted after the boot),
+ * except the jobs replaying a movie. The floppies and tapes are write protected,
+ * unless -w is given (the jobs of a same image then write in it concurrently).
+ * With -l, the files of the Thomson DOS floppies of the jobs are listed instead,
+ * without emulating them. */
+
+#ifndef THEODORE_THREADS
+#error "The batch runner must be built with THREADS=1"
+#endif
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "motoemulator.h"
+#include "machinepool.h"
+#include "autostart.h"
+#include "devices.h"
+#include "dosdir.h"
+#include "movie.h"
+#include "video.h"
+#include "logger.h"
+
+#define LINE_MAX_LENGTH 1024
+#define MAX_WORKERS 256
+
+typedef struct
+{
+  int frame;
+  int index;            // order in the script
+  InputEventType type;
+  int a, b, c;          // scancode/down, axis/isOn, x/y/button
+} ScriptEvent;
+
+typedef enum { JOB_PENDING, JOB_OK, JOB_FAILED } JobStatus;
+
+typedef struct
+{
+  char image[LINE_MAX_LENGTH];
+  char script[LINE_MAX_LENGTH];
+  char model[16];
+  int frames;
+  int line;             // line in the job list
+  // results
+  JobStatus status;
+  const char *error;
+  double seconds;
+} Job;
+
+// Jobs [head, tail[ of a worker, the other workers steal them from the tail
+typedef struct
+{
+  pthread_mutex_t lock;
+  int head, tail;
+} WorkQueue;
+
+static Job *jobs = NULL;
+static int njobs = 0;
+static WorkQueue *queues = NULL;
+static int nworkers = 0;
+static const char *outputdir = ".";
+static int64_t emulateddate = 0;
+static MachinePool *pool = NULL;     // machines started from a booted state (-b)
+static bool writablemedia = false;   // the jobs can write in their images (-w)
+
+static void batch_log(enum retro_log_level level, const char *fmt, ...)
+{
+  va_list ap;
+  if (level < RETRO_LOG_WARN) return;
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+}
+
+static double Now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static const struct { const char *name; ThomsonModel model; } models[] = {
+  {"TO8", TO8}, {"TO8D", TO8D}, {"TO9", TO9}, {"TO9+", TO9P}, {"MO5", MO5},
+  {"MO6", MO6}, {"PC128", PC128}, {"TO7", TO7}, {"TO7/70", TO7_70} };
+
+// Returns the model of a job, or -1 if the name is unknown
+static int ModelFromName(const char *name, const char *image)
+{
+  unsigned int i;
+  if (strcmp(name, "Auto") == 0)
+  {
+    name = autodetect_model(image);
+    if (name[0] == '\0') return TO8;
+  }
+  for (i = 0; i < sizeof(models) / sizeof(models[0]); i++)
+  {
+    if (strcmp(name, models[i].name) == 0) return models[i].model;
+  }
+  return -1;
+}
+
+static const char *ModelName(ThomsonModel model)
+{
+  unsigned int i;
+  for (i = 0; i < sizeof(models) / sizeof(models[0]); i++)
+  {
+    if (models[i].model == model) return models[i].name;
+  }
+  return "?";
+}
+
+static bool IsMovieFile(const char *filename)
+{
+  const char *extension = strrchr(filename, '.');
+  return (extension != NULL) && (strcasecmp(extension, ".tmv") == 0);
+}
+
+static bool IsBlankLine(const char *line)
+{
+  while ((*line == ' ') || (*line == '\t')) line++;
+  return (*line == '\0') || (*line == '\n') || (*line == '\r') || (*line == '#');
+}
+
+static bool ReadJobList(const char *filename)
+{
+  char line[LINE_MAX_LENGTH];
+  int capacity = 0, nline = 0, n;
+  FILE *f = fopen(filename, "r");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Cannot open %s: %s\n", filename, strerror(errno));
+    return false;
+  }
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    Job *job;
+    nline++;
+    if (IsBlankLine(line)) continue;
+    if (njobs == capacity)
+    {
+      capacity = capacity ? 2 * capacity : 64;
+      jobs = realloc(jobs, capacity * sizeof(Job));
+      if (jobs == NULL)
+      {
+        fprintf(stderr, "Not enough memory\n");
+        fclose(f);
+        return false;
+      }
+    }
+    job = &jobs[njobs];
+    memset(job, 0, sizeof(Job));
+    n = sscanf(line, "%1023s %15s %d %1023s", job->image, job->model, &job->frames, job->script);
+    if ((n < 3) || (job->frames < 0))
+    {
+      fprintf(stderr, "%s:%d: expected \"image model frames [script]\"\n", filename, nline);
+      fclose(f);
+      return false;
+    }
+    if (ModelFromName(job->model, job->image) < 0)
+    {
+      fprintf(stderr, "%s:%d: unknown model %s\n", filename, nline, job->model);
+      fclose(f);
+      return false;
+    }
+    job->line = nline;
+    njobs++;
+  }
+  fclose(f);
+  return true;
+}
+
+static int CompareEvents(const void *e1, const void *e2)
+{
+  const ScriptEvent *a = e1, *b = e2;
+  // Events of the same frame keep their order in the script
+  if (a->frame != b->frame) return (a->frame < b->frame) ? -1 : 1;
+  return (a->index < b->index) ? -1 : (a->index > b->index);
+}
+
+// Reads an input script, the events are sorted by frame.
+// Returns the number of events, or -1 on error.
+static int ReadScript(const char *filename, ScriptEvent **events)
+{
+  char line[LINE_MAX_LENGTH];
+  char type[8];
+  int capacity = 0, n = 0;
+  FILE *f = fopen(filename, "r");
+  *events = NULL;
+  if (f == NULL) return -1;
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    ScriptEvent e;
+    int nfields;
+    if (IsBlankLine(line)) continue;
+    e.c = 0;
+    nfields = sscanf(line, "%d %7s %d %d %d", &e.frame, type, &e.a, &e.b, &e.c);
+    if ((nfields >= 4) && (strcmp(type, "key") == 0)) e.type = INPUT_KEYBOARD;
+    else if ((nfields >= 4) && (strcmp(type, "joy") == 0)) e.type = INPUT_JOYSTICK;
+    else if ((nfields == 5) && (strcmp(type, "pen") == 0)) e.type = INPUT_LIGHTPEN;
+    else
+    {
+      free(*events);
+      *events = NULL;
+      fclose(f);
+      return -1;
+    }
+    if (n == capacity)
+    {
+      ScriptEvent *p;
+      capacity = capacity ? 2 * capacity : 64;
+      p = realloc(*events, capacity * sizeof(ScriptEvent));
+      if (p == NULL)
+      {
+        free(*events);
+        *events = NULL;
+        fclose(f);
+        return -1;
+      }
+      *events = p;
+    }
+    e.index = n;
+    (*events)[n++] = e;
+  }
+  fclose(f);
+  if (n > 0) qsort(*events, n, sizeof(ScriptEvent), CompareEvents);
+  return n;
+}
+
+static void QueueEvent(const ScriptEvent *e)
+{
+  switch (e->type)
+  {
+    case INPUT_KEYBOARD:
+      QueueKeyboard(0, e->a, e->b != 0);
+      break;
+    case INPUT_JOYSTICK:
+      QueueJoystick(0, (JoystickAxis) e->a, e->b != 0);
+      break;
+    case INPUT_LIGHTPEN:
+      QueueLightpen(0, e->a, e->b, e->c);
+      break;
+  }
+}
+
+// Output files of a job: <output_dir>/<line>_<image name without directory>.<extension>
+static void OutputPath(char *path, size_t size, const Job *job, const char *extension)
+{
+  const char *name = strrchr(job->image, '/');
+  name = (name != NULL) ? name + 1 : job->image;
+  snprintf(path, size, "%s/%04d_%s.%s", outputdir, job->line, name, extension);
+}
+
+static bool WriteFramebuffer(const Job *job, const uint32_t *framebuffer)
+{
+  char path[2 * LINE_MAX_LENGTH];
+  uint8_t line[XBITMAP * 3];
+  int x, y;
+  FILE *f;
+  OutputPath(path, sizeof(path), job, "ppm");
+  f = fopen(path, "wb");
+  if (f == NULL) return false;
+  fprintf(f, "P6\n%d %d\n255\n", XBITMAP, YBITMAP);
+  for (y = 0; y < YBITMAP; y++)
+  {
+    for (x = 0; x < XBITMAP; x++)
+    {
+      uint32_t p = framebuffer[y * XBITMAP + x];
+      line[3 * x] = p >> 16;
+      line[3 * x + 1] = p >> 8;
+      line[3 * x + 2] = p;
+    }
+    fwrite(line, 1, sizeof(line), f);
+  }
+  return fclose(f) == 0;
+}
+
+static bool WriteRam(const Job *job)
+{
+  char path[2 * LINE_MAX_LENGTH];
+  FILE *f;
+  OutputPath(path, sizeof(path), job, "ram");
+  f = fopen(path, "wb");
+  if (f == NULL) return false;
+  fwrite(GetRam(), 1, GetRamSize(), f);
+  return fclose(f) == 0;
+}
+
+// Inserts the media of a job (see load_file() of the libretro interface)
+static bool LoadMedia(const char *filename)
+{
+  FILE *f = fopen(filename, "rb");
+  if (f == NULL) return false;
+  fclose(f);
+  switch (get_media_type(filename))
+  {
+    case MEDIA_TAPE:
+      LoadTape(filename);
+      return true;
+    case MEDIA_FLOPPY:
+      if (is_sap_file(filename)) LoadSap(filename);
+      else LoadFd(filename);
+      return true;
+    case MEDIA_CARTRIDGE:
+      LoadMemo(filename);
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void RunJob(Job *job, uint32_t *framebuffer)
+{
+  ScriptEvent *events = NULL;
+  MovieReader *movie = NULL;
+  int nevents = 0, next = 0, frame;
+  ThomsonModel model = (ThomsonModel) ModelFromName(job->model, job->image);
+  bool pooled;
+  double start;
+  ThomsonMachine *m;
+
+  if (IsMovieFile(job->script))
+  {
+    if ((movie = OpenMovie(job->script)) == NULL)
+    {
+      job->status = JOB_FAILED;
+      job->error = "invalid input movie";
+      return;
+    }
+    model = GetMovieModel(movie);
+    snprintf(job->model, sizeof(job->model), "%s", ModelName(model));
+    if (job->frames == 0)
+    {
+      job->frames = (int) GetMovieLength(movie);
+    }
+  }
+  else if ((job->script[0] != '\0') && ((nevents = ReadScript(job->script, &events)) < 0))
+  {
+    job->status = JOB_FAILED;
+    job->error = "invalid input script";
+    return;
+  }
+  start = Now();
+  // A movie is replayed from a hardreset, like it was recorded
+  pooled = (pool != NULL) && (movie == NULL);
+  m = pooled ? AcquireMachine(pool, model) : CreateMachine();
+  if (m == NULL)
+  {
+    free(events);
+    CloseMovie(movie);
+    job->status = JOB_FAILED;
+    job->error = "not enough memory";
+    return;
+  }
+  SetCurrentMachine(m);
+  SetFloppyWriteProtect(!writablemedia);
+  SetTapeWriteProtect(!writablemedia);
+  SetVideoPixelFormat(VIDEO_PIXEL_XRGB8888);
+  SetLibRetroVideoBuffer(framebuffer);
+  SetAudioEnabled(false);
+  if (!pooled)
+  {
+    SetThomsonModel(model);
+  }
+  if (!LoadMedia(job->image))
+  {
+    job->status = JOB_FAILED;
+    job->error = "cannot load the image";
+  }
+  else
+  {
+    if (!pooled)
+    {
+      SetEmulatedDate((movie != NULL) ? GetMovieDate(movie) : emulateddate);
+      Hardreset();
+    }
+    // Only the last frame is rendered
+    SetVideoEnabled(false);
+    for (frame = 0; frame < job->frames; frame++)
+    {
+      while ((next < nevents) && (events[next].frame <= frame))
+      {
+        QueueEvent(&events[next++]);
+      }
+      if ((movie != NULL) && !ReplayMovieFrame(movie))
+      {
+        CloseMovie(movie);
+        movie = NULL;
+      }
+      if (frame == job->frames - 1)
+      {
+        SetVideoEnabled(true);
+      }
+      RunFrame();
+      ElapsedCycles();
+    }
+    job->seconds = Now() - start;
+    if (!WriteFramebuffer(job, framebuffer) || !WriteRam(job))
+    {
+      job->status = JOB_FAILED;
+      job->error = "cannot write the results";
+    }
+    else
+    {
+      job->status = JOB_OK;
+    }
+  }
+  SetCurrentMachine(NULL);
+  if (pooled)
+  {
+    ReleaseMachine(pool, m);
+  }
+  else
+  {
+    DestroyMachine(m);
+  }
+  free(events);
+  CloseMovie(movie);
+}
+
+// Returns the next job of a worker (-1 if there is no job left)
+static int NextJob(int worker)
+{
+  int i, job = -1;
+  WorkQueue *q = &queues[worker];
+  pthread_mutex_lock(&q->lock);
+  if (q->head < q->tail) job = q->head++;
+  pthread_mutex_unlock(&q->lock);
+  // Steals the last job of another worker
+  for (i = 1; (job < 0) && (i < nworkers); i++)
+  {
+    q = &queues[(worker + i) % nworkers];
+    pthread_mutex_lock(&q->lock);
+    if (q->head < q->tail) job = --q->tail;
+    pthread_mutex_unlock(&q->lock);
+  }
+  return job;
+}
+
+static void *Worker(void *arg)
+{
+  int worker = (int) (intptr_t) arg;
+  int job;
+  uint32_t *framebuffer = malloc(XBITMAP * YBITMAP * sizeof(uint32_t));
+  if (framebuffer == NULL) return NULL;
+  while ((job = NextJob(worker)) >= 0)
+  {
+    RunJob(&jobs[job], framebuffer);
+  }
+  free(framebuffer);
+  return NULL;
+}
+
+// Lists the files of the floppies of the jobs (all the units of an .fd image)
+static int ListFloppies(void)
+{
+  DosDirectory dir;
+  int i, unit, k, nfailed = 0;
+  printf("line\timage\tunit\tname\ttype\tformat\tsize\n");
+  for (i = 0; i < njobs; i++)
+  {
+    Job *job = &jobs[i];
+    bool found = false;
+    if (get_media_type(job->image) != MEDIA_FLOPPY) continue;
+    for (unit = 0; unit < (is_sap_file(job->image) ? 1 : 4); unit++)
+    {
+      if (!ReadDosDirectory(job->image, unit, &dir)) continue;
+      found = true;
+      for (k = 0; k < dir.nfiles; k++)
+      {
+        printf("%d\t%s\t%d\t%s\t%s\t%s\t%d\n", job->line, job->image, unit, dir.files[k].name,
+               GetDosFileTypeName(dir.files[k].type), dir.files[k].ascii ? "ascii" : "binary",
+               dir.files[k].size);
+      }
+    }
+    if (!found)
+    {
+      fprintf(stderr, "Line %d: no DOS directory in %s\n", job->line, job->image);
+      nfailed++;
+    }
+  }
+  free(jobs);
+  return (nfailed > 0) ? 1 : 0;
+}
+
+static void Usage(void)
+{
+  fprintf(stderr, "Usage: theodore_batch [-j workers] [-o output_dir] [-d date] [-b frames] [-w] [-l] job_list\n"
+                  "  -j  number of worker threads (default: number of processors)\n"
+                  "  -o  directory of the output files (default: current directory)\n"
+                  "  -d  date written in the ROM, in seconds since the epoch (default: now)\n"
+                  "  -b  start the jobs from machines booted for this number of frames\n"
+                  "  -w  allow the jobs to write in their floppies and tapes\n"
+                  "  -l  list the files of the floppies of the jobs, without emulating them\n");
+}
+
+int main(int argc, char **argv)
+{
+  pthread_t threads[MAX_WORKERS];
+  const char *joblist = NULL;
+  int i, nfailed = 0, bootframes = 0;
+  bool listfloppies = false;
+  double start;
+
+  nworkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  emulateddate = (int64_t) time(NULL);
+  for (i = 1; i < argc; i++)
+  {
+    if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) nworkers = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) outputdir = argv[++i];
+    else if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) emulateddate = strtoll(argv[++i], NULL, 10);
+    else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) bootframes = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-w") == 0) writablemedia = true;
+    else if (strcmp(argv[i], "-l") == 0) listfloppies = true;
+    else if ((argv[i][0] != '-') && (joblist == NULL)) joblist = argv[i];
+    else
+    {
+      Usage();
+      return 2;
+    }
+  }
+  if (joblist == NULL)
+  {
+    Usage();
+    return 2;
+  }
+  if (!ReadJobList(joblist)) return 2;
+  if (listfloppies) return ListFloppies();
+  if (nworkers < 1) nworkers = 1;
+  if (nworkers > MAX_WORKERS) nworkers = MAX_WORKERS;
+  if (nworkers > njobs) nworkers = (njobs > 0) ? njobs : 1;
+
+  log_cb = batch_log;
+  InitMachines();
+  if (bootframes > 0)
+  {
+    pool = CreateMachinePool(emulateddate, bootframes);
+    if (pool == NULL) return 2;
+  }
+  // Consecutive jobs of the list are given to each worker
+  queues = calloc(nworkers, sizeof(WorkQueue));
+  if (queues == NULL) return 2;
+  for (i = 0; i < nworkers; i++)
+  {
+    pthread_mutex_init(&queues[i].lock, NULL);
+    queues[i].head = (int) ((int64_t) njobs * i / nworkers);
+    queues[i].tail = (int) ((int64_t) njobs * (i + 1) / nworkers);
+  }
+  start = Now();
+  for (i = 0; i < nworkers; i++)
+  {
+    if (pthread_create(&threads[i], NULL, Worker, (void *) (intptr_t) i) != 0)
+    {
+      fprintf(stderr, "Cannot create the worker threads\n");
+      return 2;
+    }
+  }
+  for (i = 0; i < nworkers; i++)
+  {
+    pthread_join(threads[i], NULL);
+  }
+
+  // Report, in the order of the job list
+  printf("line\tstatus\tmodel\tframes\tseconds\tfps\timage\n");
+  for (i = 0; i < njobs; i++)
+  {
+    Job *job = &jobs[i];
+    if (job->status == JOB_OK)
+    {
+      printf("%d\tok\t%s\t%d\t%.3f\t%.0f\t%s\n", job->line, job->model, job->frames,
+             job->seconds, (job->seconds > 0) ? job->frames / job->seconds : 0.0, job->image);
+    }
+    else
+    {
+      printf("%d\terror (%s)\t%s\t%d\t\t\t%s\n", job->line,
+             job->error ? job->error : "not run", job->model, job->frames, job->image);
+      nfailed++;
+    }
+  }
+  fprintf(stderr, "%d jobs, %d failed, %d workers, %.3f s\n", njobs, nfailed, nworkers, Now() - start);
+  for (i = 0; i < nworkers; i++)
+  {
+    pthread_mutex_destroy(&queues[i].lock);
+  }
+  free(queues);
+  free(jobs);
+  DestroyMachinePool(pool);
+  return (nfailed > 0) ? 1 : 0;
+}
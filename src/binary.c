@@ -0,0 +1,246 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Direct loading of machine language programs, e.g. built by a cross-assembler.
+ * The program is copied in memory with the current memory mapping once the
+ * computer waits for a key after its boot, and its entry point is called as
+ * EXEC does (an RTS goes back to the monitor or to BASIC). The file is checked
+ * periodically: when it is modified, the computer is reset and runs the new
+ * version of the program. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <streams/file_stream.h>
+#include "binary.h"
+#include "6809cpu.h"
+#include "logger.h"
+#include "motoemulator.h"
+#include "movie.h"
+
+// The file is checked once per second
+#define RELOAD_CHECK_FRAMES 50
+
+// Blocs du format BIN : [00][taille][adresse][donnees]... puis [FF][00 00][execution]
+#define BIN_BLOCK_DATA   0x00
+#define BIN_BLOCK_END    0xff
+#define BIN_HEADER_SIZE  5
+
+static char *binaryfile = NULL;         //nom du fichier
+static unsigned char *program = NULL;   //contenu du fichier
+static int64_t programsize = 0;         //taille du fichier
+static int rawaddress = -1;             //adresse d'un binaire brut (-1 = format BIN)
+static int execaddress = 0;             //point d'entree
+static bool runrequested = false;       //programme a lancer apres le demarrage
+static int checkframes = 0;             //trames depuis la derniere lecture du fichier
+static bool filestatknown = false;      //taille et date du fichier lu connues
+static struct stat filestat;            //taille et date de modification du fichier lu
+
+// Returns true if the size or the modification date of the file differs from
+// the one of the file that was read (or if they are not available, e.g. for a
+// path handled only by the VFS of the frontend).
+static bool file_changed(void)
+{
+  struct stat st;
+  if (!filestatknown || (stat(binaryfile, &st) != 0))
+  {
+    return true;
+  }
+  return (st.st_size != filestat.st_size) || (st.st_mtime != filestat.st_mtime);
+}
+
+// Returns the load address of a raw binary given at the end of the name of
+// the file ("name@6000.bin"), or -1 if there is none.
+static int get_raw_address(const char *filename)
+{
+  const char *at = strrchr(filename, '@');
+  char *end;
+  long address;
+  if ((at == NULL) || (strchr(at, '/') != NULL) || (strchr(at, '\\') != NULL))
+  {
+    return -1;
+  }
+  address = strtol(at + 1, &end, 16);
+  if ((end == at + 1) || ((*end != '.') && (*end != '\0')) || (address < 0) || (address > 0xffff))
+  {
+    return -1;
+  }
+  return (int) address;
+}
+
+// Checks the blocks of a file in the BIN format and returns its entry point (-1 if not valid)
+static int get_bin_exec_address(const unsigned char *data, int64_t size)
+{
+  int64_t i = 0;
+  while (i + BIN_HEADER_SIZE <= size)
+  {
+    int length = (data[i + 1] << 8) | data[i + 2];
+    if (data[i] == BIN_BLOCK_END)
+    {
+      return (data[i + 3] << 8) | data[i + 4];
+    }
+    if ((data[i] != BIN_BLOCK_DATA) || (i + BIN_HEADER_SIZE + length > size))
+    {
+      break;
+    }
+    i += BIN_HEADER_SIZE + length;
+  }
+  return -1;
+}
+
+// Checks the content of the file and keeps it as the current program.
+// Returns false (and frees the data) if it is not valid.
+static bool set_program(const char *filename, void *data, int64_t size)
+{
+  int raw = get_raw_address(filename);
+  int exec = (raw >= 0) ? raw : get_bin_exec_address((const unsigned char *) data, size);
+  if ((exec < 0) || ((raw >= 0) && (raw + size > 0x10000)))
+  {
+    free(data);
+    return false;
+  }
+  free(program);
+  program = (unsigned char *) data;
+  programsize = size;
+  rawaddress = raw;
+  execaddress = exec;
+  return true;
+}
+
+static void copy_program(void)
+{
+  int64_t i = 0;
+  int k;
+  if (rawaddress >= 0)
+  {
+    for (i = 0; i < programsize; i++)
+    {
+      Mputc(rawaddress + i, program[i]);
+    }
+  }
+  else
+  {
+    // Les blocs ont ete verifies a la lecture du fichier
+    while (program[i] == BIN_BLOCK_DATA)
+    {
+      int length = (program[i + 1] << 8) | program[i + 2];
+      int address = (program[i + 3] << 8) | program[i + 4];
+      for (k = 0; k < length; k++)
+      {
+        Mputc(address + k, program[i + BIN_HEADER_SIZE + k]);
+      }
+      i += BIN_HEADER_SIZE + length;
+    }
+  }
+  // Appel du point d'entree comme par EXEC
+  dc6809_s -= 2;
+  Mputw(dc6809_s, dc6809_pc);
+  dc6809_pc = execaddress;
+  LOG_INFO("Program %s started at $%04X.\n", binaryfile, execaddress);
+}
+
+// Reads the file again and restarts the computer if it has been modified
+static void check_reload(void)
+{
+  void *data = NULL;
+  int64_t size;
+  struct stat st;
+  bool statknown;
+  // Le fichier n'est relu que si sa taille ou sa date ont change
+  if (!file_changed())
+  {
+    return;
+  }
+  // Date relevee avant la lecture : une ecriture pendant la lecture sera vue plus tard
+  statknown = (stat(binaryfile, &st) == 0);
+  if (!filestream_read_file(binaryfile, &data, &size) || (data == NULL))
+  {
+    return;
+  }
+  if ((size == programsize) && (memcmp(data, program, size) == 0))
+  {
+    free(data);
+    filestatknown = statknown;
+    filestat = st;
+    return;
+  }
+  // Fichier invalide (en cours d'ecriture ?) : il sera relu plus tard
+  if (!set_program(binaryfile, data, size))
+  {
+    return;
+  }
+  filestatknown = statknown;
+  filestat = st;
+  LOG_INFO("File %s modified, the computer is restarted.\n", binaryfile);
+  Hardreset();
+  RunBinary();
+}
+
+bool LoadBinary(const char *filename)
+{
+  void *data = NULL;
+  int64_t size;
+  UnloadBinary();
+  filestatknown = (stat(filename, &filestat) == 0);
+  if (!filestream_read_file(filename, &data, &size) || (data == NULL))
+  {
+    LOG_ERROR("Cannot read file %s.\n", filename);
+    return false;
+  }
+  if (!set_program(filename, data, size))
+  {
+    LOG_ERROR("File %s is neither a BIN file nor a raw binary with its address in its name.\n", filename);
+    return false;
+  }
+  binaryfile = strdup(filename);
+  RunBinary();
+  return true;
+}
+
+void UnloadBinary(void)
+{
+  free(binaryfile);
+  binaryfile = NULL;
+  free(program);
+  program = NULL;
+  programsize = 0;
+  runrequested = false;
+  filestatknown = false;
+}
+
+void RunBinary(void)
+{
+  runrequested = (program != NULL);
+}
+
+void UpdateBinary(void)
+{
+  if (binaryfile == NULL) return;
+  // The computer is not restarted during a movie (the restart is not recorded)
+  if (!IsMovieActive() && (++checkframes >= RELOAD_CHECK_FRAMES))
+  {
+    checkframes = 0;
+    check_reload();
+  }
+  if (runrequested && IsWaitingForKey())
+  {
+    runrequested = false;
+    copy_program();
+  }
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Direct loading of machine language programs (Thomson BIN or raw binary files) */
+
+#ifndef __BINARY_H
+#define __BINARY_H
+
+#include "boolean.h"
+
+// Reads a program: a file in the Thomson BIN format (as saved by SAVEM), or a raw
+// binary whose load address (also its entry point) is given in hexadecimal at the
+// end of the name of the file, e.g. "game@6000.bin".
+// Returns false if the file cannot be read or is not valid.
+bool LoadBinary(const char *filename);
+// Forgets the program
+void UnloadBinary(void);
+// Requests to copy the program in memory and to call its entry point: this is done
+// as soon as the monitor (or BASIC) waits for a key after the boot of the computer.
+void RunBinary(void);
+// To be called at each frame. When the file is modified, it is read again and the
+// computer is reset to run the new version.
+void UpdateBinary(void);
+
+#endif /* __BINARY_H */
@@ -26,6 +26,7 @@
 #include "6809cpu.h"
 #include "sap.h"
 #include "motoemulator.h"
+#include "machine.h"
 #ifdef THEODORE_DASM
 #include "debugger.h"
 #endif
@@ -39,19 +40,31 @@
 #define MONITOR_PAGE_0_MO 0x2000
 #define MONITOR_PAGE_0_TO 0x6000
 
-// Global variables
-static bool fdprotection = true;
-static bool k7protection = true;
-static bool printerEnabled = false;
-static RFILE *ffd = NULL;   // floppy file (fd format)
-static RFILE *fk7 = NULL;   // tape file
-static RFILE *fprn = NULL;  // printer file
-static SapFile sap = { 0, NULL }; // floppy file (sap format)
-static int p0 = MONITOR_PAGE_0_TO;
-static bool is_to = true;
-
-static int k7octet = 0;
-static int k7bit = 0;
+// Global variables (of the current machine)
+#define fdprotection (machine->devices.fdprotection)
+#define k7protection (machine->devices.k7protection)
+#define printerEnabled (machine->devices.printerEnabled)
+#define printerSuspended (machine->devices.printerSuspended)
+#define mediaSuspended (machine->devices.mediaSuspended)
+#define ffd (machine->devices.ffd)   // floppy file (fd format)
+#define fk7 (machine->devices.fk7)   // tape file
+#define fprn (machine->devices.fprn) // printer file
+#define sap (machine->devices.sap)   // floppy file (sap format)
+#define p0 (machine->devices.p0)
+#define is_to (machine->devices.is_to)
+
+#define k7octet (machine->devices.k7octet)
+#define k7bit (machine->devices.k7bit)
+#define fdaccesses (machine->devices.fdaccesses)
+// Memory, I/O ports and lightpen
+#define car (machine->car)                 // cartridge space 4x16K
+#define ram (machine->ram)                 // RAM 512K
+#define port (machine->state.port)         // I/O ports (0xE7C0 -> 0xE7FF)
+#define cartype (machine->cartype)         // cartridge type (0=simple 1=switch bank, 2=os-9)
+#define carflags (machine->state.carflags) // bits0,1,4=bank, 2=cart-enabled, 3=write-enabled
+#define xpen (machine->state.xpen)         // lightpen coordinates and button state
+#define ypen (machine->state.ypen)
+#define penbutton (machine->state.penbutton)
 
 // 6809 registers
 #define CC dc6809_cc
@@ -77,15 +90,34 @@ void SetTapeWriteProtect(bool enabled)
   k7protection = enabled;
 }
 
+unsigned int GetFloppyAccessCount(void)
+{
+  return fdaccesses;
+}
+
 void SetPrinterEmulationEnabled(bool enabled)
 {
   printerEnabled = enabled;
 }
 
+void SetPrinterOutputSuspended(bool suspended)
+{
+  printerSuspended = suspended;
+}
+
+void SetMediaWriteSuspended(bool suspended)
+{
+  mediaSuspended = suspended;
+}
+
 // Printer emulation
 static void Print(void)
 {
-  if (printerEnabled)
+  if (printerEnabled && printerSuspended)
+  {
+    CC &= 0xfe;
+  }
+  else if (printerEnabled)
   {
     if (fprn == NULL)
     {
@@ -123,6 +155,7 @@ static void Readsector(void)
   int i, j, u, p, s;
 
   if (ffd == NULL && sap.handle == NULL) {Diskerror(DISK_NO_DISK_ERROR); return;}
+  fdaccesses++;
   // Drive number (0/1: 2 sides of the internal drive,
   //               2/3: 2 sides of the external drive,
   //               4  : RAM disk)
@@ -159,6 +192,7 @@ static void Writesector(void)
   int i, j, u, p, s;
 
   if (ffd == NULL && sap.handle == NULL) {Diskerror(DISK_NO_DISK_ERROR); return;}
+  fdaccesses++;
   if (fdprotection) {Diskerror(DISK_WRITE_PROTECTION_ERROR); return;}
   // Drive number (0/1: 2 sides of the internal drive,
   //               2/3: 2 sides of the external drive,
@@ -171,6 +205,7 @@ static void Writesector(void)
   s = Mgetc(p0+0x4c) & 0xff; if((s == 0) || (s > SECTORS_PER_TRACK)) {Diskerror(DISK_IO_ERROR); return;}
   i = SECTOR_SIZE * (Mgetc(p0+0x4f) & 0xff) + (Mgetc(p0+0x50) & 0xff);
   for (j = 0; j < SECTOR_SIZE; j++) buffer[j] = Mgetc(i++);
+  if (mediaSuspended) return;
   if (ffd != NULL)
   {
     // FD file
@@ -193,7 +228,9 @@ static void Formatdisk(void)
   char buffer[SECTOR_SIZE];
   int i, u, fatlength;
   if (ffd == NULL) {Diskerror(DISK_NO_DISK_ERROR); return;}
+  fdaccesses++;
   if (fdprotection) {Diskerror(DISK_WRITE_PROTECTION_ERROR); return;}
+  if (mediaSuspended) return;
   u = Mgetc(p0+0x49) & 0xff; if(u > 03) return; // Unit
   u = (SECTORS_PER_SIDE * u) << 8; // Start of the unit in the .fd file
   fatlength = 160;     // 80=160Ko, 160=320Ko
@@ -242,6 +279,13 @@ void UnloadTape(void)
   if(fk7) {filestream_close(fk7); fk7 = NULL;}
 }
 
+void CloseDevices(void)
+{
+  UnloadFloppy();
+  UnloadTape();
+  if (fprn) {filestream_close(fprn); fprn = NULL;}
+}
+
 void LoadTape(const char *filename)
 {
   UnloadTape();
@@ -286,6 +330,7 @@ static void WriteByteTape(void)
 {
   if(fk7 == NULL) {Initprog(); return;}
   if(k7protection) {Initprog(); return;}
+  if (mediaSuspended) {if (!is_to) Mputc(0x2045, 0); return;}
   if (is_to)
   {
     // B register contains the byte to write
@@ -326,6 +371,7 @@ void LoadMemo(const char *filename)
   while(((c = filestream_getc(fp)) != EOF) && (carsize < CARTRIDGE_MEM_SIZE)) car[carsize++] = c;
   filestream_close(fp);
   for(i = 0; i < 0xc000; i++) ram[i] = -((i & 0x80) >> 7);
+  MarkRamModified();
   cartype = 0; // cartridge <= 16 Ko
   if(carsize > 0x4000) cartype = 1;   // bank switch system
   carflags = 4; // cartridge enabled, write disabled, bank 0
@@ -344,6 +390,7 @@ void LoadMemoFromArray(const char *rom, unsigned int rom_size)
     car[carsize++] = c;
   }
   for(i = 0; i < 0xc000; i++) ram[i] = -((i & 0x80) >> 7);
+  MarkRamModified();
   cartype = 0; // cartridge <= 16 Ko
   if(carsize > 0x4000) cartype = 1;   // bank switch system
   carflags = 4; // cartridge enabled, write disabled, bank 0
@@ -413,38 +460,38 @@ void RunIoOpcode(int opcode)
   }
 }
 
+// Etat des peripheriques dans les sauvegardes
+typedef struct
+{
+  int k7data;     //octet et bit courants de la cassette
+  int k7position; //position dans le fichier cassette
+} DeviceState;
+
 unsigned int device_serialize_size(void)
 {
-  return sizeof(int) + sizeof(int);
+  return sizeof(DeviceState);
 }
 
 void device_serialize(void *data)
 {
-  char *buffer = (char *) data;
-  int k7data;
+  DeviceState state;
+  memset(&state, 0, sizeof(state));
   if (fk7 != NULL)
   {
-    int offset = 0;
-    k7data = (k7octet << 8) + k7bit;
-    memcpy(buffer+offset, &k7data, sizeof(int));
-    offset += sizeof(int);
-    k7data = (int) filestream_tell(fk7);
-    memcpy(buffer+offset, &k7data, sizeof(int));
+    state.k7data = (k7octet << 8) + k7bit;
+    state.k7position = (int) filestream_tell(fk7);
   }
+  memcpy(data, &state, sizeof(state));
 }
 
 void device_unserialize(const void *data)
 {
-  char *buffer = (char *) data;
-  int k7data;
+  DeviceState state;
+  memcpy(&state, data, sizeof(state));
   if (fk7 != NULL)
   {
-    int offset = 0;
-    memcpy(&k7data, buffer+offset, sizeof(int));
-    offset += sizeof(int);
-    k7octet = (k7data >> 8) & 0xFF;
-    k7bit = k7data & 0xFF;
-    memcpy(&k7data, buffer+offset, sizeof(int));
-    filestream_seek(fk7, k7data, RETRO_VFS_SEEK_POSITION_START);
+    k7octet = (state.k7data >> 8) & 0xFF;
+    k7bit = state.k7data & 0xFF;
+    filestream_seek(fk7, state.k7position, RETRO_VFS_SEEK_POSITION_START);
   }
 }
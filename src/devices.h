@@ -31,8 +31,14 @@ void SetModeTO(bool isTO);
 void SetFloppyWriteProtect(bool enabled);
 // Set or unset the tape's write protection
 void SetTapeWriteProtect(bool enabled);
+// Number of accesses to the floppy (sectors read or written, formatting) of the machine
+unsigned int GetFloppyAccessCount(void);
 // Enable or disable the printer emulation
 void SetPrinterEmulationEnabled(bool enabled);
+// Discard the printer output (frames emulated ahead, which are run again later)
+void SetPrinterOutputSuspended(bool suspended);
+// Discard the writes to the floppy and to the tape (same use)
+void SetMediaWriteSuspended(bool suspended);
 
 // Load a floppy disk (fd format)
 void LoadFd(const char *filename);
@@ -52,6 +58,8 @@ void UnloadTape(void);
 void UnloadMemo(void);
 // Rewind the tape
 void RewindTape(void);
+// Close the files of the devices (floppy, tape and printer)
+void CloseDevices(void);
 
 // Run an input/output related opcode.
 // These "wrong" opcodes come from the patching of the ROM
@@ -0,0 +1,162 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Digest of the state of the emulator.
+ * The hash of each RAM page is kept, so that only the pages written since
+ * the previous digest are hashed again. The digest is the hash of the state
+ * without the RAM, combined with the hashes of the RAM pages of the model. */
+
+#include <stdlib.h>
+#include "digest.h"
+#include "motoemulator.h"
+
+#define PRIME64_1 0x9e3779b185ebca87ULL
+#define PRIME64_2 0xc2b2ae3d27d4eb4fULL
+#define PRIME64_3 0x165667b19e3779f9ULL
+#define PRIME64_4 0x85ebca77c2b2ae63ULL
+#define PRIME64_5 0x27d4eb2f165667c5ULL
+
+static uint64_t pagehash[RAM_PAGE_NUMBER]; // Hash of each RAM page
+static bool pagehashvalid = false;         // All the page hashes are up to date
+static ThomsonModel digestmodel;           // Model of the previous digest
+static unsigned int digestcheckpoint;      // RAM modifications since the previous digest
+static uint8_t *hotstate = NULL;           // State without the RAM
+
+static uint64_t Rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t Read64(const uint8_t *p)
+{
+  return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24)
+      | ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static uint64_t Read32(const uint8_t *p)
+{
+  return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24);
+}
+
+static uint64_t Round64(uint64_t acc, uint64_t input)
+{
+  acc += input * PRIME64_2;
+  acc = Rotl64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static uint64_t MergeRound64(uint64_t acc, uint64_t value)
+{
+  acc ^= Round64(0, value);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t Hash64(const void *data, size_t length, uint64_t seed)
+{
+  const uint8_t *p = (const uint8_t *) data;
+  const uint8_t *end = p + length;
+  uint64_t h;
+
+  if (length >= 32)
+  {
+    const uint8_t *limit = end - 32;
+    uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+    uint64_t v2 = seed + PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME64_1;
+    do
+    {
+      v1 = Round64(v1, Read64(p));
+      v2 = Round64(v2, Read64(p + 8));
+      v3 = Round64(v3, Read64(p + 16));
+      v4 = Round64(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+    h = MergeRound64(h, v1);
+    h = MergeRound64(h, v2);
+    h = MergeRound64(h, v3);
+    h = MergeRound64(h, v4);
+  }
+  else
+  {
+    h = seed + PRIME64_5;
+  }
+  h += (uint64_t) length;
+
+  while (p + 8 <= end)
+  {
+    h ^= Round64(0, Read64(p));
+    h = Rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    p += 8;
+  }
+  if (p + 4 <= end)
+  {
+    h ^= Read32(p) * PRIME64_1;
+    h = Rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  while (p < end)
+  {
+    h ^= *p * PRIME64_5;
+    h = Rotl64(h, 11) * PRIME64_1;
+    p++;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+uint64_t StateDigest(void)
+{
+  char *ram = GetRam();
+  int npages = GetRamSize() >> RAM_PAGE_SHIFT;
+  unsigned int size = toemulator_hotstate_size();
+  int i;
+
+  if (GetThomsonModel() != digestmodel)
+  {
+    pagehashvalid = false;
+  }
+  for (i = 0; i < npages; i++)
+  {
+    if (!pagehashvalid || IsRamPageModified(i, digestcheckpoint))
+    {
+      pagehash[i] = Hash64(ram + (i << RAM_PAGE_SHIFT), 1 << RAM_PAGE_SHIFT, i);
+    }
+  }
+  digestcheckpoint = RamCheckpoint();
+  digestmodel = GetThomsonModel();
+  pagehashvalid = true;
+
+  if (hotstate == NULL)
+  {
+    hotstate = malloc(size);
+    if (hotstate == NULL)
+    {
+      return 0;
+    }
+  }
+  toemulator_serialize_hotstate(hotstate);
+  return Hash64(pagehash, npages * sizeof(uint64_t), Hash64(hotstate, size, 0));
+}
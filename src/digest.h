@@ -0,0 +1,39 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Digest of the state of the emulator */
+
+#ifndef __DIGEST_H
+#define __DIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 64-bit hash of a buffer (xxHash64 algorithm)
+uint64_t Hash64(const void *data, size_t length, uint64_t seed);
+// Returns a digest of the state of the emulator: the hash of the hashes of the
+// RAM pages of the model (each page hashed with its number as seed), seeded with
+// the hash of the state without the RAM (toemulator_serialize_hotstate). Only the
+// pages written since the previous call are hashed again. It is not the hash of
+// the serialized state, and the media are not covered (e.g. a floppy image is
+// written in place). Two emulators with the same state have the same digest
+// only if both compute it with this scheme.
+uint64_t StateDigest(void);
+
+#endif /* __DIGEST_H */
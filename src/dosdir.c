@@ -0,0 +1,211 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Directory of the Thomson DOS floppy disks (.fd and .sap images).
+ * Track 20 of a unit holds the name of the disk (sector 1), the FAT (sector 2)
+ * and the directory (sectors 3 to 16), as written by Formatdisk in devices.c.
+ * The disk is divided in blocks of 8 sectors (2 blocks per track). The byte
+ * n+1 of the FAT describes the block n: 0xFF free, 0xFE reserved, 0x00-0x9F
+ * next block of the file, 0xC1-0xC8 last block of the file (with 1 to 8
+ * sectors used). Each entry of the directory is 32 bytes long: name (8),
+ * extension (3), type, ASCII flag, first block, number of bytes used in the
+ * last sector (2), comment and date. */
+
+#include <ctype.h>
+#include <string.h>
+#include <streams/file_stream.h>
+#include "dosdir.h"
+#include "autostart.h"
+#include "sap.h"
+
+#define DIRECTORY_TRACK     20
+#define NAME_SECTOR         1
+#define FAT_SECTOR          2
+#define FIRST_DIR_SECTOR    3
+#define LAST_DIR_SECTOR     16
+#define SECTORS_PER_TRACK   16
+#define SECTORS_PER_BLOCK   8
+#define MAX_BLOCKS          160
+#define MAX_SECTOR_SIZE     256
+#define FD_UNIT_SIZE        (80 * SECTORS_PER_TRACK * MAX_SECTOR_SIZE)
+#define ENTRY_SIZE          32
+
+#define FAT_FREE            0xff
+#define FAT_LAST_MIN        0xc1
+#define FAT_LAST_MAX        0xc8
+#define ENTRY_DELETED       0x00
+#define ENTRY_END           0xff
+
+typedef struct
+{
+  RFILE *fd;            //image .fd (NULL pour une image .sap)
+  SapFile sap;          //image .sap
+  int64_t unitoffset;   //debut de l'unite dans l'image .fd
+  int sectorsize;
+} Disk;
+
+static bool read_sector(const Disk *disk, int track, int sector, unsigned char *data)
+{
+  if (disk->fd != NULL)
+  {
+    int64_t offset = disk->unitoffset + (int64_t) (track * SECTORS_PER_TRACK + sector - 1) * disk->sectorsize;
+    return (filestream_seek(disk->fd, offset, RETRO_VFS_SEEK_POSITION_START) == 0)
+        && (filestream_read(disk->fd, data, disk->sectorsize) == disk->sectorsize);
+  }
+  return sap_readSector(&disk->sap, track, sector, (char *) data) == DISK_NO_ERROR;
+}
+
+// Copies a name padded with spaces, without the spaces
+static int copy_name(char *dest, const unsigned char *src, int length)
+{
+  int i, n = length;
+  while ((n > 0) && (src[n - 1] == ' ')) n--;
+  for (i = 0; i < n; i++)
+  {
+    dest[i] = isprint(src[i]) ? (char) src[i] : '?';
+  }
+  dest[n] = '\0';
+  return n;
+}
+
+// Follows the chain of blocks of a file in the FAT and returns its size in bytes
+static int get_file_size(const Disk *disk, const unsigned char *fat, int nblocks,
+                         int firstblock, int lastbytes)
+{
+  int block = firstblock, count = 0, blocksize = SECTORS_PER_BLOCK * disk->sectorsize;
+  while ((block < nblocks) && (count <= nblocks))
+  {
+    int next = fat[block + 1];
+    if ((next >= FAT_LAST_MIN) && (next <= FAT_LAST_MAX))
+    {
+      return count * blocksize + (next - FAT_LAST_MIN) * disk->sectorsize + lastbytes;
+    }
+    block = next;
+    count++;
+  }
+  return -1;
+}
+
+static bool read_directory(const Disk *disk, DosDirectory *dir)
+{
+  unsigned char fat[MAX_SECTOR_SIZE], sector[MAX_SECTOR_SIZE];
+  int i, s, nblocks = disk->sectorsize - 1;
+  if (nblocks > MAX_BLOCKS) nblocks = MAX_BLOCKS;
+  memset(dir, 0, sizeof(DosDirectory));
+  dir->blocksize = SECTORS_PER_BLOCK * disk->sectorsize;
+  // Le premier octet de la FAT est toujours nul
+  if (!read_sector(disk, DIRECTORY_TRACK, FAT_SECTOR, fat) || (fat[0] != 0))
+  {
+    return false;
+  }
+  for (i = 0; i < nblocks; i++)
+  {
+    if (fat[i + 1] == FAT_FREE) dir->freeblocks++;
+  }
+  if (read_sector(disk, DIRECTORY_TRACK, NAME_SECTOR, sector) && (sector[0] != 0xff))
+  {
+    copy_name(dir->diskname, sector, 8);
+  }
+  for (s = FIRST_DIR_SECTOR; s <= LAST_DIR_SECTOR; s++)
+  {
+    if (!read_sector(disk, DIRECTORY_TRACK, s, sector))
+    {
+      return false;
+    }
+    for (i = 0; i < disk->sectorsize; i += ENTRY_SIZE)
+    {
+      const unsigned char *entry = sector + i;
+      DosFile *file;
+      int n;
+      if (entry[0] == ENTRY_END) return true;
+      if ((entry[0] == ENTRY_DELETED) || (dir->nfiles >= DOS_MAX_FILES)) continue;
+      // Une entree qui designe un bloc inexistant n'est pas un repertoire DOS
+      if (entry[13] >= nblocks) return false;
+      file = &dir->files[dir->nfiles++];
+      n = copy_name(file->name, entry, 8);
+      if (entry[8] != ' ')
+      {
+        file->name[n] = '.';
+        copy_name(file->name + n + 1, entry + 8, 3);
+      }
+      file->type = (DosFileType) entry[11];
+      file->ascii = (entry[12] == 0xff);
+      file->size = get_file_size(disk, fat, nblocks, entry[13], (entry[14] << 8) | entry[15]);
+    }
+  }
+  return true;
+}
+
+bool ReadDosDirectory(const char *filename, int unit, DosDirectory *dir)
+{
+  Disk disk;
+  bool result;
+  memset(&disk, 0, sizeof(Disk));
+  if (is_sap_file(filename))
+  {
+    if (unit != 0) return false;
+    disk.sap = sap_open(filename);
+    if (disk.sap.handle == NULL) return false;
+    disk.sectorsize = (disk.sap.format == 2) ? 128 : 256;
+    result = read_directory(&disk, dir);
+    sap_close(&disk.sap);
+  }
+  else
+  {
+    disk.fd = filestream_open(filename, RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+    if (disk.fd == NULL) return false;
+    disk.unitoffset = (int64_t) unit * FD_UNIT_SIZE;
+    disk.sectorsize = MAX_SECTOR_SIZE;
+    result = read_directory(&disk, dir);
+    filestream_close(disk.fd);
+  }
+  return result;
+}
+
+const DosFile *FindDosFile(const DosDirectory *dir, const char *name)
+{
+  int i, k;
+  for (i = 0; i < dir->nfiles; i++)
+  {
+    const char *s = dir->files[i].name;
+    for (k = 0; (s[k] != '\0') && (toupper((unsigned char) s[k]) == toupper((unsigned char) name[k])); k++);
+    if ((s[k] == '\0') && (name[k] == '\0'))
+    {
+      return &dir->files[i];
+    }
+  }
+  return NULL;
+}
+
+const char *GetDosFileTypeName(DosFileType type)
+{
+  switch (type)
+  {
+    case DOS_FILE_BASIC:
+      return "BAS";
+    case DOS_FILE_DATA:
+      return "DAT";
+    case DOS_FILE_BINARY:
+      return "BIN";
+    case DOS_FILE_SOURCE:
+      return "ASM";
+    default:
+      return "???";
+  }
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Directory of the Thomson DOS floppy disks (.fd and .sap images) */
+
+#ifndef __DOSDIR_H
+#define __DOSDIR_H
+
+#include "boolean.h"
+
+// 14 sectors of 8 entries on track 20
+#define DOS_MAX_FILES 112
+// "NAME.EXT" with the trailing spaces removed
+#define DOS_NAME_LENGTH 13
+
+// Type of a file, as in the directory
+typedef enum { DOS_FILE_BASIC = 0, DOS_FILE_DATA = 1, DOS_FILE_BINARY = 2, DOS_FILE_SOURCE = 3 } DosFileType;
+
+typedef struct
+{
+  char name[DOS_NAME_LENGTH];
+  DosFileType type;
+  bool ascii;           // BASIC program or data saved as text
+  int size;             // in bytes (-1 if the chain of blocks in the FAT is broken)
+} DosFile;
+
+typedef struct
+{
+  char diskname[9];     // empty if the disk has no name
+  int nfiles;
+  int freeblocks;
+  int blocksize;        // in bytes
+  DosFile files[DOS_MAX_FILES];
+} DosDirectory;
+
+// Reads the directory and the FAT of a unit (0-3, only 0 for a .sap image)
+// of a floppy image, without the emulated computer.
+// Returns false if the file cannot be read or has no Thomson DOS directory.
+bool ReadDosDirectory(const char *filename, int unit, DosDirectory *dir);
+// Returns the file with the given name ("NAME.EXT", case insensitive), or NULL
+const DosFile *FindDosFile(const DosDirectory *dir, const char *name);
+// Returns a short name for the type of a file ("BAS", "DAT", "BIN" or "ASM")
+const char *GetDosFileTypeName(DosFileType type);
+
+#endif /* __DOSDIR_H */
@@ -533,5 +533,441 @@ const char libretroKeyCodeToThomsonMo6ScanCode[RETROK_LAST] =
   0x40     /* 323 ([ on Thomson keyboard) */
 };
 
+/* Mapping ASCII -> Thomson TO scancodes */
+const short asciiToThomsonToScanCode[128] =
+{
+    -1, /* 0 */   -1, /* 1 */   -1, /* 2 */   -1, /* 3 */   -1, /* 4 */   -1, /* 5 */   -1, /* 6 */   -1, /* 7 */
+    -1, /* 8 */   -1, /* 9 */
+  0x46,    /* '\n' */
+    -1, /* 11 */   -1, /* 12 */
+  0x46,    /* '\r' */
+    -1, /* 14 */   -1, /* 15 */   -1, /* 16 */   -1, /* 17 */   -1, /* 18 */   -1, /* 19 */   -1, /* 20 */   -1, /* 21 */
+    -1, /* 22 */   -1, /* 23 */   -1, /* 24 */   -1, /* 25 */   -1, /* 26 */   -1, /* 27 */   -1, /* 28 */   -1, /* 29 */
+    -1, /* 30 */   -1, /* 31 */
+  0x34,    /* ' ' */
+  0x39,    /* '!' */
+  0x19,    /* '"' */
+  0x28,    /* '#' */
+  0x3c,    /* '$' */
+  ASCII_SHIFT | 0x45,    /* '%' */
+  ASCII_SHIFT | 0x3c,    /* '&' */
+  0x11,    /* '\'' */
+  0x09,    /* '(' */
+  0x4c,    /* ')' */
+  0x29,    /* '*' */
+  ASCII_SHIFT | 0x0c,    /* '+' */
+  0x37,    /* ',' */
+  0x44,    /* '-' */
+  0x26,    /* '.' */
+  ASCII_SHIFT | 0x47,    /* '/' */
+  0x1e,    /* '0' */
+  0x15,    /* '1' */
+  0x25,    /* '2' */
+  0x4e,    /* '3' */
+  0x1d,    /* '4' */
+  0x2d,    /* '5' */
+  0x2e,    /* '6' */
+  0x1c,    /* '7' */
+  0x24,    /* '8' */
+  0x35,    /* '9' */
+  0x47,    /* ':' */
+  0x3f,    /* ';' */
+  ASCII_SHIFT | 0x4f,    /* '<' */
+  0x0c,    /* '=' */
+  0x4f,    /* '>' */
+  ASCII_SHIFT | 0x37,    /* '?' */
+  ASCII_SHIFT | 0x28,    /* '@' */
+  0x2a,    /* 'A' */
+  0x0f,    /* 'B' */
+  0x1f,    /* 'C' */
+  0x1b,    /* 'D' */
+  0x1a,    /* 'E' */
+  0x13,    /* 'F' */
+  0x0b,    /* 'G' */
+  0x03,    /* 'H' */
+  0x3a,    /* 'I' */
+  0x33,    /* 'J' */
+  0x3b,    /* 'K' */
+  0x43,    /* 'L' */
+  0x4b,    /* 'M' */
+  0x07,    /* 'N' */
+  0x42,    /* 'O' */
+  0x4a,    /* 'P' */
+  0x2b,    /* 'Q' */
+  0x12,    /* 'R' */
+  0x23,    /* 'S' */
+  0x0a,    /* 'T' */
+  0x32,    /* 'U' */
+  0x17,    /* 'V' */
+  0x2f,    /* 'W' */
+  0x27,    /* 'X' */
+  0x02,    /* 'Y' */
+  0x22,    /* 'Z' */
+  0x2c,    /* '[' */
+  ASCII_SHIFT | 0x44,    /* '\\' */
+  0x3e,    /* ']' */
+  0x4d,    /* '^' */
+  0x01,    /* '_' */
+    -1, /* '`' */
+  0x2a,    /* 'a' */
+  0x0f,    /* 'b' */
+  0x1f,    /* 'c' */
+  0x1b,    /* 'd' */
+  0x1a,    /* 'e' */
+  0x13,    /* 'f' */
+  0x0b,    /* 'g' */
+  0x03,    /* 'h' */
+  0x3a,    /* 'i' */
+  0x33,    /* 'j' */
+  0x3b,    /* 'k' */
+  0x43,    /* 'l' */
+  0x4b,    /* 'm' */
+  0x07,    /* 'n' */
+  0x42,    /* 'o' */
+  0x4a,    /* 'p' */
+  0x2b,    /* 'q' */
+  0x12,    /* 'r' */
+  0x23,    /* 's' */
+  0x0a,    /* 't' */
+  0x32,    /* 'u' */
+  0x17,    /* 'v' */
+  0x2f,    /* 'w' */
+  0x27,    /* 'x' */
+  0x02,    /* 'y' */
+  0x22,    /* 'z' */
+  ASCII_SHIFT | 0x2c,    /* '{' */
+    -1, /* '|' */
+  ASCII_SHIFT | 0x3e,    /* '}' */
+    -1, /* '~' */
+    -1  /* 127 */
+};
+
+/* Mapping ASCII -> Thomson MO5 and TO7/TO7-70 scancodes */
+const short asciiToThomsonMo5ScanCode[128] =
+{
+    -1, /* 0 */   -1, /* 1 */   -1, /* 2 */   -1, /* 3 */   -1, /* 4 */   -1, /* 5 */   -1, /* 6 */   -1, /* 7 */
+    -1, /* 8 */   -1, /* 9 */
+  0x34,    /* '\n' */
+    -1, /* 11 */   -1, /* 12 */
+  0x34,    /* '\r' */
+    -1, /* 14 */   -1, /* 15 */   -1, /* 16 */   -1, /* 17 */   -1, /* 18 */   -1, /* 19 */   -1, /* 20 */   -1, /* 21 */
+    -1, /* 22 */   -1, /* 23 */   -1, /* 24 */   -1, /* 25 */   -1, /* 26 */   -1, /* 27 */   -1, /* 28 */   -1, /* 29 */
+    -1, /* 30 */   -1, /* 31 */
+  0x20,    /* ' ' */
+  ASCII_SHIFT | 0x2f,    /* '!' */
+  ASCII_SHIFT | 0x27,    /* '"' */
+  ASCII_SHIFT | 0x1f,    /* '#' */
+  ASCII_SHIFT | 0x17,    /* '$' */
+  ASCII_SHIFT | 0x0f,    /* '%' */
+  ASCII_SHIFT | 0x07,    /* '&' */
+  ASCII_SHIFT | 0x06,    /* '\'' */
+  ASCII_SHIFT | 0x0e,    /* '(' */
+  ASCII_SHIFT | 0x16,    /* ')' */
+  0x2c,    /* '*' */
+  0x2e,    /* '+' */
+  0x08,    /* ',' */
+  0x26,    /* '-' */
+  0x10,    /* '.' */
+  0x24,    /* '/' */
+  0x1e,    /* '0' */
+  0x2f,    /* '1' */
+  0x27,    /* '2' */
+  0x1f,    /* '3' */
+  0x17,    /* '4' */
+  0x0f,    /* '5' */
+  0x07,    /* '6' */
+  0x06,    /* '7' */
+  0x0e,    /* '8' */
+  0x16,    /* '9' */
+  ASCII_SHIFT | 0x2c,    /* ':' */
+  ASCII_SHIFT | 0x2e,    /* ';' */
+  ASCII_SHIFT | 0x08,    /* '<' */
+  ASCII_SHIFT | 0x26,    /* '=' */
+  ASCII_SHIFT | 0x10,    /* '>' */
+  ASCII_SHIFT | 0x24,    /* '?' */
+  0x18,    /* '@' */
+  0x2d,    /* 'A' */
+  0x22,    /* 'B' */
+  0x32,    /* 'C' */
+  0x1b,    /* 'D' */
+  0x1d,    /* 'E' */
+  0x13,    /* 'F' */
+  0x0b,    /* 'G' */
+  0x03,    /* 'H' */
+  0x0c,    /* 'I' */
+  0x02,    /* 'J' */
+  0x0a,    /* 'K' */
+  0x12,    /* 'L' */
+  0x1a,    /* 'M' */
+  0x00,    /* 'N' */
+  0x14,    /* 'O' */
+  0x1c,    /* 'P' */
+  0x2b,    /* 'Q' */
+  0x15,    /* 'R' */
+  0x23,    /* 'S' */
+  0x0d,    /* 'T' */
+  0x04,    /* 'U' */
+  0x2a,    /* 'V' */
+  0x30,    /* 'W' */
+  0x28,    /* 'X' */
+  0x05,    /* 'Y' */
+  0x25,    /* 'Z' */
+    -1, /* '[' */
+    -1, /* '\\' */
+    -1, /* ']' */
+  ASCII_SHIFT | 0x18,    /* '^' */
+    -1, /* '_' */
+    -1, /* '`' */
+  0x2d,    /* 'a' */
+  0x22,    /* 'b' */
+  0x32,    /* 'c' */
+  0x1b,    /* 'd' */
+  0x1d,    /* 'e' */
+  0x13,    /* 'f' */
+  0x0b,    /* 'g' */
+  0x03,    /* 'h' */
+  0x0c,    /* 'i' */
+  0x02,    /* 'j' */
+  0x0a,    /* 'k' */
+  0x12,    /* 'l' */
+  0x1a,    /* 'm' */
+  0x00,    /* 'n' */
+  0x14,    /* 'o' */
+  0x1c,    /* 'p' */
+  0x2b,    /* 'q' */
+  0x15,    /* 'r' */
+  0x23,    /* 's' */
+  0x0d,    /* 't' */
+  0x04,    /* 'u' */
+  0x2a,    /* 'v' */
+  0x30,    /* 'w' */
+  0x28,    /* 'x' */
+  0x05,    /* 'y' */
+  0x25,    /* 'z' */
+    -1, /* '{' */
+    -1, /* '|' */
+    -1, /* '}' */
+    -1, /* '~' */
+    -1  /* 127 */
+};
+
+/* Mapping ASCII -> Thomson MO6 scancodes (AZERTY keyboard) */
+const short asciiToThomsonMo6ScanCode[128] =
+{
+    -1, /* 0 */   -1, /* 1 */   -1, /* 2 */   -1, /* 3 */   -1, /* 4 */   -1, /* 5 */   -1, /* 6 */   -1, /* 7 */
+    -1, /* 8 */   -1, /* 9 */
+  0x26,    /* '\n' */
+    -1, /* 11 */   -1, /* 12 */
+  0x26,    /* '\r' */
+    -1, /* 14 */   -1, /* 15 */   -1, /* 16 */   -1, /* 17 */   -1, /* 18 */   -1, /* 19 */   -1, /* 20 */   -1, /* 21 */
+    -1, /* 22 */   -1, /* 23 */   -1, /* 24 */   -1, /* 25 */   -1, /* 26 */   -1, /* 27 */   -1, /* 28 */   -1, /* 29 */
+    -1, /* 30 */   -1, /* 31 */
+  0x04,    /* ' ' */
+  ASCII_SHIFT | 0x31,    /* '!' */
+  ASCII_SHIFT | 0x3b,    /* '"' */
+  0x03,    /* '#' */
+  0x25,    /* '$' */
+  ASCII_SHIFT | 0x44,    /* '%' */
+  ASCII_SHIFT | 0x25,    /* '&' */
+  ASCII_SHIFT | 0x3a,    /* '\'' */
+  ASCII_SHIFT | 0x39,    /* '(' */
+  0x42,    /* ')' */
+  ASCII_SHIFT | 0x3d,    /* '*' */
+  ASCII_SHIFT | 0x35,    /* '+' */
+  0x01,    /* ',' */
+  0x34,    /* '-' */
+  ASCII_SHIFT | 0x02,    /* '.' */
+  ASCII_SHIFT | 0x24,    /* '/' */
+  0x33,    /* '0' */
+  0x3d,    /* '1' */
+  0x3c,    /* '2' */
+  0x3b,    /* '3' */
+  0x3a,    /* '4' */
+  0x39,    /* '5' */
+  0x38,    /* '6' */
+  0x30,    /* '7' */
+  0x31,    /* '8' */
+  0x32,    /* '9' */
+  0x24,    /* ':' */
+  0x02,    /* ';' */
+  ASCII_SHIFT | 0x0a,    /* '<' */
+  0x35,    /* '=' */
+  0x0a,    /* '>' */
+  ASCII_SHIFT | 0x01,    /* '?' */
+  ASCII_SHIFT | 0x03,    /* '@' */
+  0x2d,    /* 'A' */
+  0x14,    /* 'B' */
+  0x16,    /* 'C' */
+  0x1b,    /* 'D' */
+  0x2b,    /* 'E' */
+  0x1a,    /* 'F' */
+  0x19,    /* 'G' */
+  0x18,    /* 'H' */
+  0x21,    /* 'I' */
+  0x10,    /* 'J' */
+  0x11,    /* 'K' */
+  0x12,    /* 'L' */
+  0x13,    /* 'M' */
+  0x00,    /* 'N' */
+  0x22,    /* 'O' */
+  0x23,    /* 'P' */
+  0x1d,    /* 'Q' */
+  0x2a,    /* 'R' */
+  0x1c,    /* 'S' */
+  0x29,    /* 'T' */
+  0x20,    /* 'U' */
+  0x15,    /* 'V' */
+  0x06,    /* 'W' */
+  0x05,    /* 'X' */
+  0x28,    /* 'Y' */
+  0x2c,    /* 'Z' */
+  0x40,    /* '[' */
+  ASCII_SHIFT | 0x34,    /* '\\' */
+  0x41,    /* ']' */
+  0x43,    /* '^' */
+  ASCII_SHIFT | 0x38,    /* '_' */
+    -1, /* '`' */
+  0x2d,    /* 'a' */
+  0x14,    /* 'b' */
+  0x16,    /* 'c' */
+  0x1b,    /* 'd' */
+  0x2b,    /* 'e' */
+  0x1a,    /* 'f' */
+  0x19,    /* 'g' */
+  0x18,    /* 'h' */
+  0x21,    /* 'i' */
+  0x10,    /* 'j' */
+  0x11,    /* 'k' */
+  0x12,    /* 'l' */
+  0x13,    /* 'm' */
+  0x00,    /* 'n' */
+  0x22,    /* 'o' */
+  0x23,    /* 'p' */
+  0x1d,    /* 'q' */
+  0x2a,    /* 'r' */
+  0x1c,    /* 's' */
+  0x29,    /* 't' */
+  0x20,    /* 'u' */
+  0x15,    /* 'v' */
+  0x06,    /* 'w' */
+  0x05,    /* 'x' */
+  0x28,    /* 'y' */
+  0x2c,    /* 'z' */
+  ASCII_SHIFT | 0x40,    /* '{' */
+    -1, /* '|' */
+  ASCII_SHIFT | 0x41,    /* '}' */
+    -1, /* '~' */
+    -1  /* 127 */
+};
+
+/* Mapping ASCII -> Thomson PC128 scancodes (QWERTY keyboard) */
+const short asciiToThomsonPc128ScanCode[128] =
+{
+    -1, /* 0 */   -1, /* 1 */   -1, /* 2 */   -1, /* 3 */   -1, /* 4 */   -1, /* 5 */   -1, /* 6 */   -1, /* 7 */
+    -1, /* 8 */   -1, /* 9 */
+  0x26,    /* '\n' */
+    -1, /* 11 */   -1, /* 12 */
+  0x26,    /* '\r' */
+    -1, /* 14 */   -1, /* 15 */   -1, /* 16 */   -1, /* 17 */   -1, /* 18 */   -1, /* 19 */   -1, /* 20 */   -1, /* 21 */
+    -1, /* 22 */   -1, /* 23 */   -1, /* 24 */   -1, /* 25 */   -1, /* 26 */   -1, /* 27 */   -1, /* 28 */   -1, /* 29 */
+    -1, /* 30 */   -1, /* 31 */
+  0x04,    /* ' ' */
+  ASCII_SHIFT | 0x3d,    /* '!' */
+  ASCII_SHIFT | 0x3c,    /* '"' */
+  0x41,    /* '#' */
+  ASCII_SHIFT | 0x3a,    /* '$' */
+  ASCII_SHIFT | 0x39,    /* '%' */
+  ASCII_SHIFT | 0x38,    /* '&' */
+  0x34,    /* '\'' */
+  ASCII_SHIFT | 0x31,    /* '(' */
+  ASCII_SHIFT | 0x32,    /* ')' */
+  ASCII_SHIFT | 0x25,    /* '*' */
+  0x25,    /* '+' */
+  0x02,    /* ',' */
+  0x0a,    /* '-' */
+  0x24,    /* '.' */
+  ASCII_SHIFT | 0x30,    /* '/' */
+  0x33,    /* '0' */
+  0x3d,    /* '1' */
+  0x3c,    /* '2' */
+  0x3b,    /* '3' */
+  0x3a,    /* '4' */
+  0x39,    /* '5' */
+  0x38,    /* '6' */
+  0x30,    /* '7' */
+  0x31,    /* '8' */
+  0x32,    /* '9' */
+  ASCII_SHIFT | 0x24,    /* ':' */
+  ASCII_SHIFT | 0x02,    /* ';' */
+  ASCII_SHIFT | 0x40,    /* '<' */
+  ASCII_SHIFT | 0x33,    /* '=' */
+  0x40,    /* '>' */
+  ASCII_SHIFT | 0x42,    /* '?' */
+  ASCII_SHIFT | 0x43,    /* '@' */
+  0x1d,    /* 'A' */
+  0x14,    /* 'B' */
+  0x16,    /* 'C' */
+  0x1b,    /* 'D' */
+  0x2b,    /* 'E' */
+  0x1a,    /* 'F' */
+  0x19,    /* 'G' */
+  0x18,    /* 'H' */
+  0x21,    /* 'I' */
+  0x10,    /* 'J' */
+  0x11,    /* 'K' */
+  0x12,    /* 'L' */
+  0x01,    /* 'M' */
+  0x00,    /* 'N' */
+  0x22,    /* 'O' */
+  0x23,    /* 'P' */
+  0x2d,    /* 'Q' */
+  0x2a,    /* 'R' */
+  0x1c,    /* 'S' */
+  0x29,    /* 'T' */
+  0x20,    /* 'U' */
+  0x15,    /* 'V' */
+  0x2c,    /* 'W' */
+  0x05,    /* 'X' */
+  0x28,    /* 'Y' */
+  0x06,    /* 'Z' */
+  0x03,    /* '[' */
+  ASCII_SHIFT | 0x3e,    /* '\\' */
+  0x35,    /* ']' */
+  ASCII_SHIFT | 0x41,    /* '^' */
+  ASCII_SHIFT | 0x0a,    /* '_' */
+  ASCII_SHIFT | 0x34,    /* '`' */
+  0x1d,    /* 'a' */
+  0x14,    /* 'b' */
+  0x16,    /* 'c' */
+  0x1b,    /* 'd' */
+  0x2b,    /* 'e' */
+  0x1a,    /* 'f' */
+  0x19,    /* 'g' */
+  0x18,    /* 'h' */
+  0x21,    /* 'i' */
+  0x10,    /* 'j' */
+  0x11,    /* 'k' */
+  0x12,    /* 'l' */
+  0x01,    /* 'm' */
+  0x00,    /* 'n' */
+  0x22,    /* 'o' */
+  0x23,    /* 'p' */
+  0x2d,    /* 'q' */
+  0x2a,    /* 'r' */
+  0x1c,    /* 's' */
+  0x29,    /* 't' */
+  0x20,    /* 'u' */
+  0x15,    /* 'v' */
+  0x2c,    /* 'w' */
+  0x05,    /* 'x' */
+  0x28,    /* 'y' */
+  0x06,    /* 'z' */
+  ASCII_SHIFT | 0x03,    /* '{' */
+    -1, /* '|' */
+  ASCII_SHIFT | 0x35,    /* '}' */
+    -1, /* '~' */
+    -1  /* 127 */
+};
+
 /* Mapping libretro -> Thomson scancodes for the current MO/TO version */
 const char *libretroKeyCodeToThomsonScanCode = libretroKeyCodeToThomsonToScanCode;
@@ -30,6 +30,16 @@ extern const char libretroKeyCodeToThomsonMo5ScanCode[RETROK_LAST];
 /* Mapping libretro -> Thomson MO6 scancodes */
 extern const char libretroKeyCodeToThomsonMo6ScanCode[RETROK_LAST];
 
+/* Mapping ASCII -> Thomson scancodes (-1 = no key), for the text typed on the
+   keyboard. The letters are typed without SHIFT (their case depends on CAPSLOCK),
+   the other characters with SHIFT if ASCII_SHIFT is set. */
+#define ASCII_SHIFT 0x100
+extern const short asciiToThomsonToScanCode[128];
+/* MO5, TO7 and TO7/70 */
+extern const short asciiToThomsonMo5ScanCode[128];
+extern const short asciiToThomsonMo6ScanCode[128];
+extern const short asciiToThomsonPc128ScanCode[128];
+
 /* Mapping libretro -> Thomson scancodes for the current MO/TO version */
 extern const char *libretroKeyCodeToThomsonScanCode;
 
@@ -20,19 +20,29 @@
 #include <libretro.h>
 #include <boolean.h>
 #include <streams/file_stream.h>
+#include <file/file_path.h>
+#include <retro_miscellaneous.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #ifdef THEODORE_DASM
 #include "debugger.h"
 #endif
+#include "audio.h"
 #include "autostart.h"
 #include "devices.h"
+#include "digest.h"
+#include "rewind.h"
 #include "keymap.h"
 #include "logger.h"
+#include "movie.h"
+#include "paste.h"
+#include "basic.h"
+#include "binary.h"
 #include "sap.h"
 #include "motoemulator.h"
 #include "video.h"
@@ -51,20 +61,20 @@ void linearFree(void* mem);
 #endif
 
 #define MAX_CONTROLLERS   2
-#define VIDEO_FPS         50
-#define AUDIO_SAMPLE_RATE 22050
-#define AUDIO_SAMPLE_PER_FRAME (AUDIO_SAMPLE_RATE / VIDEO_FPS)
+#define VIDEO_FPS         ((double) CPU_FREQUENCY / FRAME_CYCLES)
+#define DEFAULT_AUDIO_SAMPLE_RATE 22050
 #define CPU_FREQUENCY     1000000
 // Pitch = length in bytes between two lines in video buffer
-#define PITCH             sizeof(pixel_fmt_t) * XBITMAP
-// Autorun: Number of frames to wait before simulating
-// the key stroke to start the program
+#define PITCH             (GetVideoPixelSize() * XBITMAP)
+// Size of the video buffer (large enough for all pixel formats)
+#define VIDEO_BUFFER_SIZE (XBITMAP * YBITMAP * sizeof(uint32_t))
+// Autorun: Max number of frames to wait for the computer to be ready
+// before simulating the key strokes to start the program
 #define AUTORUN_DELAY     70
 // Virtual keyboard: Number of frames to wait when B button is pushed
 // to make the key sticky
 #define VKB_STICKY_KEY_DELAY 25
 
-retro_log_printf_t log_cb = NULL;
 static retro_environment_t environ_cb = NULL;
 static retro_video_refresh_t video_cb = NULL;
 static retro_audio_sample_t audio_cb = NULL;
@@ -73,16 +83,59 @@ static retro_input_poll_t input_poll_cb = NULL;
 static retro_input_state_t input_state_cb = NULL;
 
 static unsigned int input_type[MAX_CONTROLLERS];
-static pixel_fmt_t *video_buffer = NULL;
-static int16_t audio_stereo_buffer[2*AUDIO_SAMPLE_PER_FRAME];
+static void *video_buffer = NULL;
+static enum retro_pixel_format pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+// Framebuffer used to render the current frame (video_buffer or the frontend's one)
+static void *frame_buffer = NULL;
+static size_t frame_pitch = 0;
+// True if the frontend accepts duplicated frames (video_cb called with NULL)
+static bool can_dupe = false;
+
+// Frameskip
+enum FrameskipMode { FRAMESKIP_DISABLED, FRAMESKIP_AUTO, FRAMESKIP_MANUAL };
+// Maximum number of consecutive frames skipped in auto mode
+#define FRAMESKIP_MAX 30
+// Audio latency (in frames) requested to the frontend when frameskip is enabled
+#define FRAMESKIP_AUDIO_LATENCY 6
+static enum FrameskipMode frameskip_mode = FRAMESKIP_DISABLED;
+// Nb of frames to skip between 2 rendered frames (manual mode)
+static int frameskip_value = 0;
+// Nb of consecutive frames skipped
+static int frameskip_counter = 0;
+// State of the frontend's audio buffer
+static bool audio_buffer_active = false;
+static bool audio_buffer_underrun_likely = false;
+
+// Nb of frames emulated ahead to reduce the input latency (0 = disabled)
+static int runahead_frames = 0;
+// Rewind enabled (the buffer size is set by a core option)
+static bool rewind_enabled = false;
+
+// Digest of the state computed after each frame (for desync detection),
+// available as a memory region (8 bytes) and optionally logged
+#define RETRO_MEMORY_STATE_DIGEST 0x100
+enum StateDigestMode { STATE_DIGEST_DISABLED, STATE_DIGEST_ENABLED, STATE_DIGEST_LOG };
+static enum StateDigestMode state_digest_mode = STATE_DIGEST_DISABLED;
+static uint64_t state_digest = 0;
+static int16_t audio_stereo_buffer[2*AUDIO_MAX_SAMPLES_PER_FRAME];
+static int audio_sample_rate = DEFAULT_AUDIO_SAMPLE_RATE;
 
-// nb of thousandth of cycles in excess to run the next time
-static int excess = 0;
 
 // Autorun counter
 static int autorun_counter = -1;
 // True when autostart is in progress
 static bool autostart_pending = false;
+// Boot snapshot to save when the computer is ready to start the game (empty = none)
+static char boot_snapshot_path[PATH_MAX_LENGTH] = "";
+// Day of the boot snapshot (YYYYMMDD), written before the state
+#define BOOT_SNAPSHOT_DATE_SIZE 8
+static char boot_snapshot_date[BOOT_SNAPSHOT_DATE_SIZE + 1];
+// Accesses to the floppy when the game was loaded (the boot must not read the disk)
+static unsigned int boot_snapshot_floppy_accesses;
+// Last value of the model option
+static char model_option[16] = "";
+// Last value of the paste option (-1 = not read yet)
+static int paste_option = -1;
 
 // True if the virtual keyboard must be showed
 static bool vkb_show = false;
@@ -101,9 +154,18 @@ struct ButtonsState last_btn_state = { false, false, false, false,
 
 static const struct retro_variable prefs[] = {
     { PACKAGE_NAME"_rom", "Thomson model; Auto|TO8|TO8D|TO9|TO9+|MO5|MO6|PC128|TO7|TO7/70" },
+    { PACKAGE_NAME"_pixel_format", "Pixel format (restart); RGB565|XRGB8888" },
     { PACKAGE_NAME"_autorun", "Auto run game; disabled|enabled" },
     { PACKAGE_NAME"_autostart_use_game_hash", "Use game hash for autostart; enabled|disabled" },
     { PACKAGE_NAME"_autostart_message_hint", "Display hint to start a game; enabled|disabled" },
+    { PACKAGE_NAME"_boot_snapshot", "Skip the boot with auto run (snapshot in system dir); disabled|enabled" },
+    { PACKAGE_NAME"_paste", "Paste theodore_paste.txt (system dir) when enabled; disabled|enabled" },
+    { PACKAGE_NAME"_audio_sample_rate", "Audio sample rate (Hz); 22050|44100|48000" },
+    { PACKAGE_NAME"_runahead", "Run-ahead to reduce latency (frames); disabled|1|2|3|4" },
+    { PACKAGE_NAME"_rewind", "Rewind (buffer size in MB); disabled|4|16|64" },
+    { PACKAGE_NAME"_state_digest", "State digest after each frame; disabled|enabled|log" },
+    { PACKAGE_NAME"_movie", "Input movie (restart); disabled|record|play" },
+    { PACKAGE_NAME"_frameskip", "Frameskip; disabled|auto|1|2|3|4" },
     { PACKAGE_NAME"_vkb_transparency", "Virtual keyboard transparency; 0%|10%|20%|30%|40%|50%|60%|70%|80%|90%" },
     { PACKAGE_NAME"_floppy_write_protect", "Floppy write protection; enabled|disabled" },
     { PACKAGE_NAME"_tape_write_protect", "Tape write protection; enabled|disabled" },
@@ -186,6 +248,7 @@ void retro_init(void)
         { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_SELECT,"Show/Hide Virtual Keyboard" },
         { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_START, "Start Program" },
         { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_Y,     "Move Virtual Keyboard" },
+        { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L,     "Rewind (hold)" },
 
         { 1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT,  "Left" },
         { 1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP,    "Up" },
@@ -214,15 +277,17 @@ void retro_init(void)
 
   environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
+  InitMachines();
+  InitAudio(CPU_FREQUENCY, audio_sample_rate);
   Hardreset();
 #ifdef _3DS
-  video_buffer = (pixel_fmt_t *)linearMemAlign(XBITMAP * YBITMAP * sizeof(pixel_fmt_t), 0x80);
+  video_buffer = linearMemAlign(VIDEO_BUFFER_SIZE, 0x80);
 #else
-  video_buffer = (pixel_fmt_t *)malloc(XBITMAP * YBITMAP * sizeof(pixel_fmt_t));
+  video_buffer = malloc(VIDEO_BUFFER_SIZE);
 #endif
   SetLibRetroVideoBuffer(video_buffer);
 
-  vkb_configure_virtual_keyboard(video_buffer, XBITMAP, YBITMAP);
+  vkb_configure_virtual_keyboard(video_buffer, XBITMAP, YBITMAP, VKB_PIXEL_RGB565);
 }
 
 void retro_deinit(void)
@@ -236,6 +301,9 @@ void retro_deinit(void)
 #endif
     video_buffer = NULL;
   }
+  frameskip_mode = FRAMESKIP_DISABLED;
+  SetRewindBufferSize(0);
+  rewind_enabled = false;
 }
 
 unsigned retro_api_version(void)
@@ -248,7 +316,7 @@ void retro_get_system_info(struct retro_system_info *info)
   memset(info, 0, sizeof(*info));
   info->library_name = PACKAGE_NAME;
   info->library_version = PACKAGE_VERSION;
-  info->valid_extensions = "fd|sap|k7|m7|m5|rom";
+  info->valid_extensions = "fd|sap|k7|m7|m5|rom|bas|bin";
   info->need_fullpath = true;
   info->block_extract = false;
 }
@@ -257,7 +325,7 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 {
   memset(info, 0, sizeof(*info));
   info->timing.fps = VIDEO_FPS;
-  info->timing.sample_rate = AUDIO_SAMPLE_RATE;
+  info->timing.sample_rate = audio_sample_rate;
   info->geometry.base_width = XBITMAP;
   info->geometry.base_height = YBITMAP;
   info->geometry.max_width = XBITMAP;
@@ -287,7 +355,15 @@ void retro_cheat_set(unsigned index, bool enabled, const char *code)
 
 void retro_reset(void)
 {
+  // The computer may not be ready when the game is started
+  boot_snapshot_path[0] = '\0';
+  StopPaste();
+  autostart_stop();
+  // The reset is not recorded in the movies: the movie ends there
+  StopMovie();
   Hardreset();
+  // A binary program is started again after the boot
+  RunBinary();
 }
 
 static void pointerToScreenCoordinates(int *x, int *y)
@@ -317,14 +393,11 @@ static void update_input_virtual_keyboard()
   click = input_state_cb(MAX_CONTROLLERS, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED);
 
   // Try to start the currently loaded program
-  if (!vkb_show && start && !last_btn_state.start)
+  if ((autostart_pending || (!vkb_show && start && !last_btn_state.start)) && !IsTyping())
   {
-    autostart_pending = true;
-  }
-  else if (autostart_pending)
-  {
-    autostart_pending = autostart_nextkey();
+    autostart_typekeys();
   }
+  autostart_pending = false;
 
   // Show the virtual keyboard?
   if (select && !last_btn_state.select)
@@ -340,15 +413,15 @@ static void update_input_virtual_keyboard()
       {
         if (sticky_scancodes[i] != -1)
         {
-          keyboard(sticky_scancodes[i], false);
+          QueueKeyboard(0, sticky_scancodes[i], false);
         }
       }
       vkb_release_all_sticky_keys();
-      keyboard(vkb_get_current_key_scancode(), false);
+      QueueKeyboard(0, vkb_get_current_key_scancode(), false);
       // If start is pressed than release also the Enter key
       if (start)
       {
-        keyboard(libretroKeyCodeToThomsonScanCode[RETROK_RETURN], false);
+        QueueKeyboard(0, libretroKeyCodeToThomsonScanCode[RETROK_RETURN], false);
       }
     }
   }
@@ -380,7 +453,7 @@ static void update_input_virtual_keyboard()
       // Do not release key if held
       if (b || !vkb_is_key_sticky(vkb_get_current_key_scancode()))
       {
-        keyboard(vkb_get_current_key_scancode(), b);
+        QueueKeyboard(0, vkb_get_current_key_scancode(), b);
       }
     }
     // Press and hold key
@@ -403,12 +476,12 @@ static void update_input_virtual_keyboard()
               // Key held
               if (scancodes[i] != -1)
               {
-                keyboard(scancodes[i], true);
+                QueueKeyboard(0, scancodes[i], true);
               }
               // Key released
               else
               {
-                keyboard(scancodes_prev[i], false);
+                QueueKeyboard(0, scancodes_prev[i], false);
               }
             }
           }
@@ -437,7 +510,7 @@ static void update_input_virtual_keyboard()
       // If start is pressed than press the Enter key
       if ((start && !last_btn_state.start) || (!start && last_btn_state.start))
       {
-        keyboard(libretroKeyCodeToThomsonScanCode[RETROK_RETURN], start);
+        QueueKeyboard(0, libretroKeyCodeToThomsonScanCode[RETROK_RETURN], start);
       }
     }
   }
@@ -461,29 +534,37 @@ static void update_input(void)
   if (!vkb_show)
   {
     // Joystick 1
-    Joysemul(JOY0_UP, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP));
-    Joysemul(JOY0_DOWN, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN));
-    Joysemul(JOY0_LEFT, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT));
-    Joysemul(JOY0_RIGHT, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT));
-    Joysemul(JOY0_FIRE, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B));
+    QueueJoystick(0, JOY0_UP, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP));
+    QueueJoystick(0, JOY0_DOWN, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN));
+    QueueJoystick(0, JOY0_LEFT, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT));
+    QueueJoystick(0, JOY0_RIGHT, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT));
+    QueueJoystick(0, JOY0_FIRE, input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B));
     // Joystick 2
-    Joysemul(JOY1_UP, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP));
-    Joysemul(JOY1_DOWN, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN));
-    Joysemul(JOY1_LEFT, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT));
-    Joysemul(JOY1_RIGHT, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT));
-    Joysemul(JOY1_FIRE, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B));
+    QueueJoystick(0, JOY1_UP, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP));
+    QueueJoystick(0, JOY1_DOWN, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN));
+    QueueJoystick(0, JOY1_LEFT, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT));
+    QueueJoystick(0, JOY1_RIGHT, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT));
+    QueueJoystick(0, JOY1_FIRE, input_state_cb(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B));
 
     // Light pen
     xpointer = input_state_cb(MAX_CONTROLLERS, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_X);
     ypointer = input_state_cb(MAX_CONTROLLERS, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_Y);
     pointerToScreenCoordinates(&xpointer, &ypointer);
-    xpen = xpointer - 16;
-    ypen = (ypointer - 16) / 2;
-    penbutton = input_state_cb(MAX_CONTROLLERS, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED);
+    QueueLightpen(0, xpointer - 16, (ypointer - 16) / 2,
+                  input_state_cb(MAX_CONTROLLERS, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED));
   }
 
   // Virtual keyboard management
   update_input_virtual_keyboard();
+
+  // BASIC listing written in memory (and run by a pasted RUN command)
+  UpdateBasic();
+  // Binary program copied in memory and reloaded when its file is modified
+  UpdateBinary();
+  // Start command of a floppy, typed once BASIC is ready
+  autostart_update();
+  // Text pasted on the keyboard
+  UpdatePaste();
 }
 
 static bool is_option_enabled(char* option)
@@ -515,6 +596,16 @@ static void display_start_hint()
   }
 }
 
+// A change of model resets the computer: it ends the movie (which could not be replayed)
+static void set_model(ThomsonModel model)
+{
+  if (IsMovieActive() && (model != GetThomsonModel()))
+  {
+    StopMovie();
+  }
+  SetThomsonModel(model);
+}
+
 static void change_model(const char *model)
 {
   display_start_hint();
@@ -537,57 +628,156 @@ static void change_model(const char *model)
   }
   if (strcmp(model, "TO8") == 0)
   {
-    SetThomsonModel(TO8);
+    set_model(TO8);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
   }
   else if (strcmp(model, "TO8D") == 0)
   {
-    SetThomsonModel(TO8D);
+    set_model(TO8D);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
   }
   else if (strcmp(model, "TO9") == 0)
   {
-    SetThomsonModel(TO9);
+    set_model(TO9);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
   }
   else if (strcmp(model, "TO9+") == 0)
   {
-    SetThomsonModel(TO9P);
+    set_model(TO9P);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
   }
   else if (strcmp(model, "MO5") == 0)
   {
-    SetThomsonModel(MO5);
+    set_model(MO5);
     vkb_set_virtual_keyboard_model(VKB_MODEL_MO5);
   }
   else if (strcmp(model, "MO6") == 0)
   {
-    SetThomsonModel(MO6);
+    set_model(MO6);
     vkb_set_virtual_keyboard_model(VKB_MODEL_MO6);
   }
   else if (strcmp(model, "PC128") == 0)
   {
-    SetThomsonModel(PC128);
+    set_model(PC128);
     vkb_set_virtual_keyboard_model(VKB_MODEL_PC128);
   }
   else if (strcmp(model, "TO7") == 0)
   {
-    SetThomsonModel(TO7);
+    set_model(TO7);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO7);
   }
   else if (strcmp(model, "TO7/70") == 0)
   {
-    SetThomsonModel(TO7_70);
+    set_model(TO7_70);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO770);
   }
   // Default: TO8
   else
   {
-    SetThomsonModel(TO8);
+    set_model(TO8);
     vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
   }
 }
 
+static void audio_buffer_status_cb(bool active, unsigned occupancy, bool underrun_likely)
+{
+  (void) occupancy;
+  audio_buffer_active = active;
+  audio_buffer_underrun_likely = underrun_likely;
+}
+
+static void set_frameskip(const char *value)
+{
+  enum FrameskipMode mode = FRAMESKIP_DISABLED;
+  struct retro_audio_buffer_status_callback buffer_status_cb;
+  unsigned int audio_latency = 0;
+
+  if (strcmp(value, "auto") == 0)
+  {
+    mode = FRAMESKIP_AUTO;
+  }
+  else if (strcmp(value, "disabled") != 0)
+  {
+    mode = FRAMESKIP_MANUAL;
+    frameskip_value = atoi(value);
+  }
+  if (mode == frameskip_mode)
+  {
+    return;
+  }
+
+  // The auto mode is driven by the occupancy of the frontend's audio buffer
+  buffer_status_cb.callback = audio_buffer_status_cb;
+  if (mode == FRAMESKIP_AUTO)
+  {
+    if (!environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buffer_status_cb))
+    {
+      LOG_WARN("Frameskip: audio buffer status is not supported, frameskip disabled.\n");
+      mode = FRAMESKIP_DISABLED;
+    }
+  }
+  else if (frameskip_mode == FRAMESKIP_AUTO)
+  {
+    environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+  }
+  audio_buffer_active = false;
+  audio_buffer_underrun_likely = false;
+
+  // A larger audio buffer leaves room to skip frames without audio underrun
+  if (mode != FRAMESKIP_DISABLED)
+  {
+    // Rounded to a multiple of 32 ms
+    audio_latency = (unsigned int) (FRAMESKIP_AUDIO_LATENCY * 1000 / VIDEO_FPS + 0.5);
+    audio_latency = (audio_latency + 0x1f) & ~0x1f;
+  }
+  environ_cb(RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY, &audio_latency);
+
+  frameskip_mode = mode;
+  frameskip_counter = 0;
+}
+
+// Returns true if the rendering of the current frame must be skipped
+static bool skip_frame(void)
+{
+  bool skip = false;
+  // A skipped frame is sent as a duplicate of the previous one
+  if (!can_dupe)
+  {
+    return false;
+  }
+  switch (frameskip_mode)
+  {
+    case FRAMESKIP_AUTO:
+      skip = audio_buffer_active && audio_buffer_underrun_likely
+             && (frameskip_counter < FRAMESKIP_MAX);
+      break;
+    case FRAMESKIP_MANUAL:
+      skip = frameskip_counter < frameskip_value;
+      break;
+    default:
+      break;
+  }
+  frameskip_counter = skip ? frameskip_counter + 1 : 0;
+  return skip;
+}
+
+// Types the text file theodore_paste.txt of the system directory on the keyboard
+static void paste_system_file(void)
+{
+  const char *system_dir = NULL;
+  char path[PATH_MAX_LENGTH];
+
+  if (!environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &system_dir) || (system_dir == NULL))
+  {
+    return;
+  }
+  fill_pathname_join(path, system_dir, PACKAGE_NAME"_paste.txt", sizeof(path));
+  if (PasteFile(path))
+  {
+    LOG_INFO("Pasting file %s.\n", path);
+  }
+}
+
 static void check_variables(void)
 {
   struct retro_variable var = {0, 0};
@@ -610,7 +800,65 @@ static void check_variables(void)
   var.key = PACKAGE_NAME"_rom";
   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
   {
-    change_model(var.value);
+    // During a movie, its model is kept until the option is changed
+    if (!IsMovieActive() || (strcmp(var.value, model_option) != 0))
+    {
+      change_model(var.value);
+    }
+    snprintf(model_option, sizeof(model_option), "%s", var.value);
+  }
+  var.key = PACKAGE_NAME"_paste";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    int enabled = (strcmp(var.value, "enabled") == 0) ? 1 : 0;
+    // The file is pasted when the option is switched on (not when the core starts)
+    if (enabled && (paste_option == 0))
+    {
+      paste_system_file();
+    }
+    paste_option = enabled;
+  }
+  var.key = PACKAGE_NAME"_audio_sample_rate";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    int rate = atoi(var.value);
+    if ((rate > 0) && (rate != audio_sample_rate))
+    {
+      audio_sample_rate = rate;
+      SetAudioSampleRate(rate);
+    }
+  }
+  var.key = PACKAGE_NAME"_runahead";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    runahead_frames = atoi(var.value);
+  }
+  var.key = PACKAGE_NAME"_rewind";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    SetRewindBufferSize(atoi(var.value) << 20);
+    rewind_enabled = (atoi(var.value) > 0);
+  }
+  var.key = PACKAGE_NAME"_state_digest";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    if (strcmp(var.value, "enabled") == 0)
+    {
+      state_digest_mode = STATE_DIGEST_ENABLED;
+    }
+    else if (strcmp(var.value, "log") == 0)
+    {
+      state_digest_mode = STATE_DIGEST_LOG;
+    }
+    else
+    {
+      state_digest_mode = STATE_DIGEST_DISABLED;
+    }
+  }
+  var.key = PACKAGE_NAME"_frameskip";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+  {
+    set_frameskip(var.value);
   }
   var.key = PACKAGE_NAME"_vkb_transparency";
   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
@@ -646,39 +894,241 @@ static void check_variables(void)
 #endif
 }
 
-void retro_run(void)
+// Renders the frame directly into the frontend's framebuffer if it is available
+// (and otherwise into the internal video buffer)
+static void acquire_frame_buffer(void)
+{
+  struct retro_framebuffer fb;
+  memset(&fb, 0, sizeof(fb));
+  fb.width = XBITMAP;
+  fb.height = YBITMAP;
+  fb.access_flags = RETRO_MEMORY_ACCESS_WRITE | RETRO_MEMORY_ACCESS_READ;
+  frame_buffer = video_buffer;
+  frame_pitch = PITCH;
+  if (environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb)
+      && (fb.data != NULL) && (fb.format == pixel_format) && (fb.pitch >= PITCH))
+  {
+    frame_buffer = fb.data;
+    frame_pitch = fb.pitch;
+    RetargetVideoBuffer(frame_buffer, frame_pitch);
+  }
+  vkb_set_video_buffer(frame_buffer, frame_pitch);
+}
+
+// The frontend's framebuffer must not be used after retro_run() returns
+static void release_frame_buffer(void)
+{
+  if (frame_buffer != video_buffer)
+  {
+    RetargetVideoBuffer(video_buffer, PITCH);
+  }
+}
+
+// Emulates the next frames with the same input and shows the last one,
+// then goes back to the current frame
+static void run_ahead(void)
 {
-  bool updated;
   int i;
-  int mcycles; // nb of thousandths of cycles between 2 samples
-  int icycles; // integer number of cycles between 2 samples
-  int16_t audio_sample;
-  // 45 cycles of the 6809 at 992250 Hz = one sample at 22050 Hz
-  for(i = 0; i < AUDIO_SAMPLE_PER_FRAME; i++)
-  {
-    // Computes the nb of cycles between 2 samples and runs the emulation for this nb of cycles
-    // Nb of theoretical cycles for this period of time =
-    // theoretical number + previous remaining - cycles in excess during the previous period
-    mcycles = 1000 * CPU_FREQUENCY / AUDIO_SAMPLE_RATE; // theoretical thousandths of cycles
-    mcycles += excess;                       // corrected thousandths of cycles
-    icycles = mcycles / 1000;                // integer number of cycles to run
-    excess = mcycles - 1000 * icycles;       // remaining to do the next time
-    excess -= 1000 * Run(icycles);           // remove thousandths in excess
-    audio_sample = GetAudioSample();
-    audio_stereo_buffer[(i << 1) + 0] = audio_stereo_buffer[(i << 1) + 1] = audio_sample;
+  // Without memory for the state, the previous frame is shown again
+  if (!SaveRunAheadState())
+  {
+    LOG_WARN("Not enough memory for the run-ahead.\n");
+    return;
   }
+  SetAudioEnabled(false);
+  SetPrinterOutputSuspended(true);
+  SetMediaWriteSuspended(true);
+  for (i = 1; i <= runahead_frames; i++)
+  {
+    if (i == runahead_frames)
+    {
+      SetVideoEnabled(true);
+      acquire_frame_buffer();
+    }
+    RunFrame();
+  }
+  release_frame_buffer();
+  ElapsedCycles();
+  SetMediaWriteSuspended(false);
+  SetPrinterOutputSuspended(false);
+  SetAudioEnabled(true);
+  RestoreRunAheadState();
+}
 
+// Boot snapshot: state of the computer when it is ready to start the game
+// (waiting for a key after the boot), saved in the system directory for each model
+// and media type. When it exists, the game is started without booting the computer.
+// The date written in the ROM is copied in the RAM at the boot, so a snapshot is
+// only used on the day it was saved (it is saved again on the next day).
+static void start_boot_snapshot(const char *filename)
+{
+  time_t now = time(NULL);
+  const char *system_dir = NULL;
+  char name[64];
+  void *data = NULL;
+  int64_t size;
+  Media media;
+  bool valid;
+
+  boot_snapshot_path[0] = '\0';
+  if ((autorun_counter <= 0) || !is_option_enabled(PACKAGE_NAME"_boot_snapshot"))
+  {
+    return;
+  }
+  // A cartridge starts by itself
+  media = get_media_type(filename);
+  if ((media != MEDIA_TAPE) && (media != MEDIA_FLOPPY))
+  {
+    return;
+  }
+  if (!environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &system_dir) || (system_dir == NULL))
+  {
+    return;
+  }
+  snprintf(name, sizeof(name), PACKAGE_NAME"_boot_%d_%s_%016llx.sta", (int) GetThomsonModel(),
+           (media == MEDIA_TAPE) ? "k7" : "fd", (unsigned long long) GetRomChecksum());
+  fill_pathname_join(boot_snapshot_path, system_dir, name, sizeof(boot_snapshot_path));
+  strftime(boot_snapshot_date, sizeof(boot_snapshot_date), "%Y%m%d", localtime(&now));
+  boot_snapshot_floppy_accesses = GetFloppyAccessCount();
+  if (!filestream_exists(boot_snapshot_path))
+  {
+    return;
+  }
+  valid = filestream_read_file(boot_snapshot_path, &data, &size) && (data != NULL)
+          && (size > BOOT_SNAPSHOT_DATE_SIZE);
+  if (valid && (memcmp(data, boot_snapshot_date, BOOT_SNAPSHOT_DATE_SIZE) != 0))
+  {
+    LOG_INFO("Boot snapshot %s saved on another day, it will be saved again.\n", boot_snapshot_path);
+  }
+  else if (valid && toemulator_unserialize((char *) data + BOOT_SNAPSHOT_DATE_SIZE,
+                                           (unsigned int) (size - BOOT_SNAPSHOT_DATE_SIZE)))
+  {
+    // The game is started immediately
+    autorun_counter = -1;
+    autostart_pending = true;
+    boot_snapshot_path[0] = '\0';
+  }
+  else
+  {
+    LOG_WARN("Invalid boot snapshot %s, it will be saved again.\n", boot_snapshot_path);
+  }
+  free(data);
+}
+
+static void save_boot_snapshot(void)
+{
+  unsigned int size;
+  void *data;
+
+  if (boot_snapshot_path[0] == '\0')
+  {
+    return;
+  }
+  size = BOOT_SNAPSHOT_DATE_SIZE + toemulator_serialize_size();
+  data = malloc(size);
+  if (data != NULL)
+  {
+    memcpy(data, boot_snapshot_date, BOOT_SNAPSHOT_DATE_SIZE);
+    toemulator_serialize((char *) data + BOOT_SNAPSHOT_DATE_SIZE);
+    if (!filestream_write_file(boot_snapshot_path, data, size))
+    {
+      LOG_WARN("Cannot save boot snapshot %s.\n", boot_snapshot_path);
+    }
+    free(data);
+  }
+  boot_snapshot_path[0] = '\0';
+}
+
+void retro_run(void)
+{
+  bool updated;
+  int nsamples;
+  int av_enable;
+  bool video_enabled, audio_enabled;
+  bool rewinding;
+  // During run-ahead or netplay resimulation, the frontend may discard the audio and/or video
+  if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable))
+  {
+    av_enable = 3;
+  }
+  video_enabled = ((av_enable & 1) != 0) && !skip_frame();
+  audio_enabled = (av_enable & 2) != 0;
+  // Input is read at the beginning of the frame, during the vertical blanking
+  MovieBeginFrame();
   update_input();
-  if (vkb_show)
+  // A movie must not go back in time (the recording or the replay would desync)
+  rewinding = rewind_enabled && !IsMovieActive()
+              && input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L);
+  if (rewinding)
+  {
+    // Goes back one frame, which is emulated again (without sound) to be displayed
+    SetAudioEnabled(false);
+    StepBackRewind();
+  }
+  if (video_enabled && (runahead_frames > 0) && !rewinding)
+  {
+    // The frame itself is not shown, but the one emulated ahead
+    SetVideoEnabled(false);
+    RunFrame();
+    nsamples = AudioEndFrame(ElapsedCycles(), audio_enabled ? audio_stereo_buffer : NULL);
+    run_ahead();
+  }
+  else
+  {
+    SetVideoEnabled(video_enabled);
+    if (video_enabled)
+    {
+      acquire_frame_buffer();
+    }
+    // Runs the emulation until the end of the frame, the screen is then complete
+    RunFrame();
+    // The audio samples of the frame are synthesized from the level changes of the DAC
+    nsamples = AudioEndFrame(ElapsedCycles(), audio_enabled ? audio_stereo_buffer : NULL);
+    if (video_enabled)
+    {
+      release_frame_buffer();
+    }
+  }
+  if (rewinding)
+  {
+    SetAudioEnabled(true);
+  }
+  else if (rewind_enabled)
+  {
+    PushRewindState();
+  }
+  if (state_digest_mode != STATE_DIGEST_DISABLED)
+  {
+    state_digest = StateDigest();
+    if (state_digest_mode == STATE_DIGEST_LOG)
+    {
+      LOG_INFO("State digest: %016llx\n", (unsigned long long) state_digest);
+    }
+  }
+  MovieEndFrame();
+
+  if (vkb_show && video_enabled)
   {
     vkb_show_virtual_keyboard();
+    // The frame without the virtual keyboard will have to be sent again
+    MarkDisplayDirty();
   }
 
   if (autorun_counter > 0)
   {
     autorun_counter--;
-    if (autorun_counter == 0)
+    // The program is started as soon as the computer waits for a key after the boot
+    if ((autorun_counter == 0) || IsWaitingForKey())
     {
+      // The boot snapshot is only saved at a key wait (not at the end of the delay,
+      // e.g. during the loading of a self-booting floppy), if the boot did not read
+      // the floppy (TO9 and MO5 read its boot sector): it would depend on this disk
+      if (IsWaitingForKey() && (GetFloppyAccessCount() == boot_snapshot_floppy_accesses))
+      {
+        save_boot_snapshot();
+      }
+      boot_snapshot_path[0] = '\0';
+      autorun_counter = 0;
       autostart_pending = true;
     }
   }
@@ -686,11 +1136,34 @@ void retro_run(void)
   updated = false;
   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
   {
+    int previous_sample_rate = audio_sample_rate;
     check_variables();
+    if (audio_sample_rate != previous_sample_rate)
+    {
+      struct retro_system_av_info av_info;
+      retro_get_system_av_info(&av_info);
+      environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &av_info);
+    }
   }
 
-  audio_batch_cb(audio_stereo_buffer, AUDIO_SAMPLE_PER_FRAME);
-  video_cb(video_buffer, XBITMAP, YBITMAP, PITCH);
+  if (audio_enabled)
+  {
+    audio_batch_cb(audio_stereo_buffer, nsamples);
+  }
+  if (!video_enabled)
+  {
+    // Frame discarded by the frontend or skipped (which requires can_dupe)
+    video_cb(can_dupe ? NULL : video_buffer, XBITMAP, YBITMAP, PITCH);
+  }
+  // IsFrameDuplicate() must be called for each rendered frame
+  else if (IsFrameDuplicate() && can_dupe)
+  {
+    video_cb(NULL, XBITMAP, YBITMAP, frame_pitch);
+  }
+  else
+  {
+    video_cb(frame_buffer, XBITMAP, YBITMAP, frame_pitch);
+  }
 }
 
 size_t retro_serialize_size(void)
@@ -707,9 +1180,15 @@ bool retro_serialize(void *data, size_t size)
 
 bool retro_unserialize(const void *data, size_t size)
 {
-  if (size != toemulator_serialize_size()) return false;
-  toemulator_unserialize(data);
-  return true;
+  // The states are refused during a movie (including the ones of the frontend's
+  // run-ahead): the recording or the replay would no longer match the session
+  if (IsMovieActive())
+  {
+    LOG_WARN("A state cannot be loaded during the recording or the replay of a movie.\n");
+    return false;
+  }
+  boot_snapshot_path[0] = '\0';
+  return toemulator_unserialize(data, size);
 }
 
 static void check_automodel(const char *filename)
@@ -777,6 +1256,18 @@ static bool load_file(const char *filename)
     case MEDIA_CARTRIDGE:
       LoadMemo(filename);
       break;
+    case MEDIA_BASIC:
+      if (!LoadBasic(filename))
+      {
+        return false;
+      }
+      break;
+    case MEDIA_BINARY:
+      if (!LoadBinary(filename))
+      {
+        return false;
+      }
+      break;
     default:
       LOG_ERROR("Unknown file type for file %s.\n", filename);
       return false;
@@ -786,6 +1277,43 @@ static bool load_file(const char *filename)
   return true;
 }
 
+// Starts the recording or the replay of the input movie of the game, if enabled.
+// The movie file is in the save directory and named after the game.
+// Returns false if the movie is disabled.
+static bool start_movie(const char *filename)
+{
+  struct retro_variable var = {0, 0};
+  const char *save_dir = NULL;
+  char name[PATH_MAX_LENGTH];
+  char path[PATH_MAX_LENGTH];
+
+  var.key = PACKAGE_NAME"_movie";
+  if (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) || (var.value == NULL)
+      || (strcmp(var.value, "disabled") == 0))
+  {
+    return false;
+  }
+  fill_pathname_base_noext(name, (filename != NULL) ? filename : PACKAGE_NAME, sizeof(name));
+  strcat(name, ".tmv");
+  if (environ_cb(RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &save_dir) && (save_dir != NULL))
+  {
+    fill_pathname_join(path, save_dir, name, sizeof(path));
+  }
+  else
+  {
+    strcpy(path, name);
+  }
+  if (strcmp(var.value, "record") == 0)
+  {
+    StartMovieRecording(path);
+  }
+  else
+  {
+    StartMoviePlayback(path);
+  }
+  return true;
+}
+
 static void keyboard_cb(bool down, unsigned keycode,
     uint32_t character, uint16_t key_modifiers)
 {
@@ -798,31 +1326,74 @@ static void keyboard_cb(bool down, unsigned keycode,
     unsigned char scancode = libretroKeyCodeToThomsonScanCode[keycode];
     if (scancode != 0xFF)
     {
-      keyboard(scancode, down);
+      QueueKeyboard(0, scancode, down);
     }
   }
 }
 
-bool retro_load_game(const struct retro_game_info *game)
+// Negotiates the pixel format with the frontend.
+// RGB565 is the default for better compatibility with low-end devices.
+static bool set_pixel_format(void)
 {
-  struct retro_keyboard_callback keyb_cb = { keyboard_cb };
-  // Use of RGB565 pixel format instead of XRGB8888
-  // for better compatibility with low-end devices
-  enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_RGB565;
+  struct retro_variable var = {0, 0};
+  enum retro_pixel_format fmt;
+
+  var.key = PACKAGE_NAME"_pixel_format";
+  if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && (strcmp(var.value, "XRGB8888") == 0))
+  {
+    fmt = RETRO_PIXEL_FORMAT_XRGB8888;
+    if (environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
+    {
+      pixel_format = fmt;
+      SetVideoPixelFormat(VIDEO_PIXEL_XRGB8888);
+      SetLibRetroVideoBuffer(video_buffer);
+      vkb_configure_virtual_keyboard(video_buffer, XBITMAP, YBITMAP, VKB_PIXEL_XRGB8888);
+      return true;
+    }
+    LOG_WARN("XRGB8888 is not supported, using RGB565.\n");
+  }
+  fmt = RETRO_PIXEL_FORMAT_RGB565;
   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
   {
     LOG_ERROR("RGB565 is not supported.\n");
     return false;
   }
+  pixel_format = fmt;
+  SetVideoPixelFormat(VIDEO_PIXEL_RGB565);
+  SetLibRetroVideoBuffer(video_buffer);
+  vkb_configure_virtual_keyboard(video_buffer, XBITMAP, YBITMAP, VKB_PIXEL_RGB565);
+  return true;
+}
+
+bool retro_load_game(const struct retro_game_info *game)
+{
+  struct retro_keyboard_callback keyb_cb = { keyboard_cb };
+  if (!set_pixel_format())
+  {
+    return false;
+  }
 
   environ_cb(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &keyb_cb);
+  if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe))
+  {
+    can_dupe = false;
+  }
 
   check_variables();
+  ClearRewind();
 
   if (game && game->path)
   {
     LOG_INFO("Loading file %s.\n", game->path);
-    return load_file(game->path);
+    if (!load_file(game->path))
+    {
+      return false;
+    }
+  }
+  // The movies begin with a hardreset of the computer
+  if (!start_movie((game != NULL) ? game->path : NULL) && game && game->path)
+  {
+    start_boot_snapshot(game->path);
   }
   return true;
 }
@@ -839,9 +1410,15 @@ bool retro_load_game_special(
 
 void retro_unload_game(void)
 {
+  boot_snapshot_path[0] = '\0';
+  StopPaste();
+  autostart_stop();
+  StopMovie();
   UnloadTape();
   UnloadFloppy();
   UnloadMemo();
+  UnloadBasic();
+  UnloadBinary();
 }
 
 unsigned retro_get_region(void)
@@ -854,7 +1431,9 @@ void *retro_get_memory_data(unsigned id)
   switch (id)
   {
     case RETRO_MEMORY_SYSTEM_RAM:
-      return ram;
+      return GetRam();
+    case RETRO_MEMORY_STATE_DIGEST:
+      return &state_digest;
   }
   return NULL;
 }
@@ -865,6 +1444,8 @@ size_t retro_get_memory_size(unsigned id)
   {
     case RETRO_MEMORY_SYSTEM_RAM:
       return RAM_SIZE;
+    case RETRO_MEMORY_STATE_DIGEST:
+      return sizeof(state_digest);
   }
   return 0;
 }
@@ -0,0 +1,213 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Context of an emulated machine.
+ * The whole state of the emulation (processor, memory, video, devices and
+ * audio) is stored in a ThomsonMachine. The emulation modules work on the
+ * machine selected by the current thread (see SetCurrentMachine), through
+ * the "machine" pointer: each module refers to the parts of the context it
+ * uses with macros named after the variables they replace, defined in its
+ * own source file (this header only defines the context).
+ * The ROM images are shared by all the machines: only the ROM banks that
+ * are written by the emulation (date, keyboard) are copied in each machine. */
+
+#ifndef __MACHINE_H
+#define __MACHINE_H
+
+#include <stdint.h>
+#include <streams/file_stream.h>
+#include "boolean.h"
+#include "audio.h"
+#include "motoemulator.h"
+#include "sap.h"
+#include "video.h"
+
+// With THREADS=1, each thread has its own current machine
+// (the machines can then be emulated in parallel)
+#ifdef THEODORE_THREADS
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+#else
+#define THREAD_LOCAL
+#endif
+
+// Size of the input events queue
+#define INPUT_QUEUE_SIZE 256
+// Number of keys of the keyboard
+#define KEYBOARDKEY_MAX 84
+#define PALETTE_SIZE    32
+// ROM banks written by the emulation: BASIC bank with the date (TO8, TO8D, TO9+)
+// and monitor bank with the code of the key pressed (TO8, TO8D)
+#define ROM_DATE_BANK      3
+#define ROM_DATE_BANK_SIZE 0x4000
+#define ROM_KEY_BANK       1
+#define ROM_KEY_BANK_SIZE  0x2000
+// Nb of samples affected by a step of the audio output
+#define BLEP_TAPS 16
+// Max number of level changes recorded before their synthesis
+#define MAX_AUDIO_EVENTS 1024
+#define DELTA_BUFFER_SIZE (AUDIO_MAX_SAMPLES_PER_FRAME + BLEP_TAPS)
+
+// Processeur 6809
+typedef struct
+{
+  char (*mgetc)(unsigned short a);         //fonction de lecture memoire
+  void (*mputc)(unsigned short a, char c); //fonction d'ecriture memoire
+  int cycles, sync, irq, firq, nmi;        //cycles additionnels, synchronisation, interruptions
+  short w;                                 //registre de travail
+  char cc;                                 //registres
+  unsigned short pc;
+  short d, x, y, u, s, da;
+  char *a, *b, *dp, *dd;                   //pointeurs vers les octets des registres
+  char *pch, *pcl, *xh, *xl, *yh, *yl, *uh, *ul, *sh, *sl;
+} Cpu6809;
+
+typedef struct
+{
+  int cycle;          // Cycle from the beginning of the frame
+  InputEventType type;
+  int a, b, c;        // scancode/down, axis/isOn, x/y/button
+} InputEvent;
+
+// Etat de la machine (hors processeur, video, peripheriques et RAM),
+// regroupe en un seul bloc dans les sauvegardes
+typedef struct
+{
+  char port[IO_MEM_SIZE];
+  char x7da[PALETTE_SIZE];
+  int touche[KEYBOARDKEY_MAX];
+  int carflags, capslock, joysposition, joysaction;
+  int xpen, ypen, penbutton;
+  int videolinecycle, videolinenumber, displayflag, bordercolor;
+  int sound, mute;
+  int timer6846, latch6846, keyb_irqcount, timer_irqcount;
+  int typedkeys[TYPED_KEYS_SIZE];    //touches tapees en attente (scancode | 0x100 si enfoncee)
+  int ntypedkeys, typedkey, keyreads, typingcycles;
+  int keywaitlines, waitingforkey;   //attente d'une touche dans la boucle du moniteur
+  int ninputevents, lastkeycycle;
+  InputEvent inputevents[INPUT_QUEUE_SIZE]; //en dernier (la fin inutilisee n'est pas sauvegardee)
+} MachineState;
+
+// Affichage
+typedef struct
+{
+  uint8_t palettergb[20][3];            //intensites r,v,b (0-15) des couleurs de la palette
+  uint16_t pcolor16[20];                //couleurs de la palette au format 16 bits
+  uint32_t pcolor32[20];                //couleurs de la palette au format XRGB8888
+  int currentvideomemory;               //index octet courant en memoire video thomson
+  int currentlinesegment;               //numero de l'octet courant dans la ligne video
+  uint8_t *pcurrentpixel;               //pointeur ecran : pixel courant
+  uint8_t *pcurrentline;                //pointeur ecran : debut ligne courante
+  uint8_t *pmin;                        //pointeur ecran : premier pixel
+  uint8_t *pmax;                        //pointeur ecran : dernier pixel + 1
+  int pitch;                            //nombre d'octets entre deux lignes ecran
+  enum VideoPixelFormat pixelformat;
+  unsigned int pixelsize;
+  enum VideoMode videomode;
+  bool displaydirty;                    //affichage modifie autrement que par ecriture en memoire video
+  bool lastframedirty;                  //trame precedente modifiee
+  unsigned int framecheckpoint;         //point de controle des ecritures en RAM a la fin de la trame precedente
+  void (*decodevideo)(void);            //decodage d'un octet de la memoire video
+  void (*displaysegment)(void);         //creation d'un segment de ligne d'ecran
+  void (*nextline)(void);               //changement de ligne ecran
+} VideoContext;
+
+// Peripheriques
+typedef struct
+{
+  bool fdprotection;
+  bool k7protection;
+  bool printerEnabled;
+  bool printerSuspended;
+  bool mediaSuspended;
+  RFILE *ffd;         // floppy file (fd format)
+  RFILE *fk7;         // tape file
+  RFILE *fprn;        // printer file
+  SapFile sap;        // floppy file (sap format)
+  int p0;
+  bool is_to;
+  int k7octet;
+  int k7bit;
+  unsigned int fdaccesses;  // number of accesses to the floppy
+} DevicesContext;
+
+typedef struct
+{
+  int cycle;
+  int level;
+} AudioEvent;
+
+// Sortie audio
+typedef struct
+{
+  AudioEvent events[MAX_AUDIO_EVENTS]; //changements de niveau de la trame
+  int cpufrequency;                    //frequence du processeur emule (Hz)
+  int nevents;                         //nombre de changements enregistres
+  int eventlevel;                      //niveau apres le dernier changement enregistre
+  int synthlevel;                      //niveau apres le dernier changement synthetise
+  int32_t deltas[DELTA_BUFFER_SIZE];   //variations du niveau pour chaque echantillon
+  int32_t integrator;                  //niveau de sortie (x 2^BLEP_SHIFT)
+  uint64_t samplespercycle;            //nombre d'echantillons par cycle (virgule fixe 32.32)
+  uint64_t frametime;                  //position du debut de la trame entre deux echantillons (32.32)
+} AudioContext;
+
+typedef struct SystemRom SystemRom;
+
+struct ThomsonMachine
+{
+  Cpu6809 cpu;
+  ThomsonModel currentModel;
+  SystemRom *rom;
+  int64_t emulateddate;             //date ecrite en ROM (0 = date courante)
+  // memoire
+  char *car;                        //espace cartouche 4x16K
+  char *ram;                        //ram 512K
+  bool mappedmemory;                //ram et cartouche partagees jusqu'a leur ecriture (mmap)
+  char datebank[ROM_DATE_BANK_SIZE]; //banque de la ROM BASIC contenant la date
+  char keybank[ROM_KEY_BANK_SIZE];  //banque de la ROM moniteur contenant le code de la touche
+  unsigned int ramclock;            //numero du point de controle courant des ecritures en RAM
+  unsigned int rampageclock[RAM_PAGE_NUMBER]; //point de controle de la derniere ecriture de chaque page
+  char *pagevideo;                  //pointeur page video affichee
+  char *ramvideo;                   //pointeur couleurs ou formes
+  char *ramuser;                    //pointeur ram utilisateur fixe
+  char *rambank;                    //pointeur banque ram utilisateur
+  char *romsys;                     //pointeur rom systeme
+  char *rombank;                    //pointeur banque rom ou cartouche
+  void (*selectVideoRam)(void);
+  void (*selectRomBank)(void);
+  int cartype;                      //type de cartouche (0=simple, 1=switch bank, 2=os-9)
+  MachineState state;
+  bool videoenabled;                //indicateur de rendu de l'affichage
+  bool audioenabled;                //transmission des changements de niveau au module audio
+  int framecycles;                  //nombre de cycles executes depuis le debut de la trame audio
+  InputFilter inputfilter;          //filtre des evenements d'entree
+  unsigned int templateid;          //etat modele de la derniere remise a zero rapide
+  unsigned int templatecheckpoint;  //point de controle des ecritures en RAM apres cette remise a zero
+  VideoContext video;
+  DevicesContext devices;
+  AudioContext audio;
+};
+
+// Machine emulated by the current thread
+extern THREAD_LOCAL ThomsonMachine *machine;
+
+#endif /* __MACHINE_H */
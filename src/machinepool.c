@@ -0,0 +1,182 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Pool of machines reset to template states.
+ * The released machines are kept with the model of their last use, so that
+ * a machine of the same model is preferably handed out: only the RAM pages it
+ * modified are then copied from the template. */
+
+#ifndef THEODORE_THREADS
+#error "The pool of machines must be built with THREADS=1"
+#endif
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "machinepool.h"
+#include "devices.h"
+
+#define MODEL_NUMBER (TO7_70 + 1)
+
+typedef struct
+{
+  ThomsonMachine *machine;
+  ThomsonModel model;       // model of its last use
+} PooledMachine;
+
+struct MachinePool
+{
+  pthread_mutex_t lock;
+  pthread_cond_t built;     // signaled when the boot of a template ends
+  int64_t date;
+  int bootframes;
+  MachineTemplate *templates[MODEL_NUMBER];
+  bool building[MODEL_NUMBER]; // template being booted by a thread
+  PooledMachine *free;      // released machines
+  int nfree;
+  int capacity;
+};
+
+MachinePool *CreateMachinePool(int64_t date, int bootframes)
+{
+  MachinePool *p = calloc(1, sizeof(MachinePool));
+  if (p == NULL) return NULL;
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->built, NULL);
+  p->date = date;
+  p->bootframes = bootframes;
+  return p;
+}
+
+void DestroyMachinePool(MachinePool *p)
+{
+  int i;
+  if (p == NULL) return;
+  for (i = 0; i < p->nfree; i++)
+  {
+    DestroyMachine(p->free[i].machine);
+  }
+  for (i = 0; i < MODEL_NUMBER; i++)
+  {
+    DestroyMachineTemplate(p->templates[i]);
+  }
+  pthread_cond_destroy(&p->built);
+  pthread_mutex_destroy(&p->lock);
+  free(p->free);
+  free(p);
+}
+
+// Boots the current machine to create the template of its model
+static MachineTemplate *BootTemplate(MachinePool *p, ThomsonModel model)
+{
+  int i;
+  SetEmulatedDate(p->date);
+  SetThomsonModel(model);
+  Hardreset();
+  for (i = 0; i < p->bootframes; i++)
+  {
+    RunFrame();
+    ElapsedCycles();
+  }
+  return CreateMachineTemplate();
+}
+
+ThomsonMachine *AcquireMachine(MachinePool *p, ThomsonModel model)
+{
+  ThomsonMachine *current = GetCurrentMachine();
+  ThomsonMachine *m = NULL;
+  MachineTemplate *t;
+  int i;
+  pthread_mutex_lock(&p->lock);
+  // A machine last used with the same model, or the last released one
+  for (i = p->nfree - 1; (i >= 0) && (p->free[i].model != model); i--);
+  if ((i < 0) && (p->nfree > 0)) i = p->nfree - 1;
+  if (i >= 0)
+  {
+    m = p->free[i].machine;
+    p->free[i] = p->free[--p->nfree];
+  }
+  pthread_mutex_unlock(&p->lock);
+  if (m == NULL)
+  {
+    m = CreateMachine();
+    if (m == NULL) return NULL;
+  }
+  SetCurrentMachine(m);
+  SetVideoEnabled(false);
+  SetAudioEnabled(false);
+  // The template of a model is created once, by the first thread that needs it.
+  // It boots without the lock of the pool, the other threads that need the same
+  // model wait for the end of the boot.
+  pthread_mutex_lock(&p->lock);
+  while ((p->templates[model] == NULL) && p->building[model])
+  {
+    pthread_cond_wait(&p->built, &p->lock);
+  }
+  t = p->templates[model];
+  if (t == NULL)
+  {
+    p->building[model] = true;
+    pthread_mutex_unlock(&p->lock);
+    t = BootTemplate(p, model);
+    pthread_mutex_lock(&p->lock);
+    p->templates[model] = t;
+    p->building[model] = false;
+    pthread_cond_broadcast(&p->built);
+  }
+  pthread_mutex_unlock(&p->lock);
+  if (t == NULL)
+  {
+    SetCurrentMachine(current);
+    ReleaseMachine(p, m);
+    return NULL;
+  }
+  ResetToTemplate(t);
+  SetCurrentMachine(current);
+  return m;
+}
+
+void ReleaseMachine(MachinePool *p, ThomsonMachine *m)
+{
+  ThomsonMachine *current = GetCurrentMachine();
+  ThomsonModel model;
+  SetCurrentMachine(m);
+  UnloadFloppy();
+  UnloadTape();
+  model = GetThomsonModel();
+  SetCurrentMachine((current != m) ? current : NULL);
+  pthread_mutex_lock(&p->lock);
+  if (p->nfree == p->capacity)
+  {
+    int capacity = p->capacity ? 2 * p->capacity : 16;
+    PooledMachine *pooled = realloc(p->free, capacity * sizeof(PooledMachine));
+    if (pooled == NULL)
+    {
+      pthread_mutex_unlock(&p->lock);
+      DestroyMachine(m);
+      return;
+    }
+    p->free = pooled;
+    p->capacity = capacity;
+  }
+  p->free[p->nfree].machine = m;
+  p->free[p->nfree].model = model;
+  p->nfree++;
+  pthread_mutex_unlock(&p->lock);
+}
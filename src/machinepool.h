@@ -0,0 +1,49 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Pool of machines ready to run: the first machine of a model is booted once
+ * and captured in a template state, then the machines handed out by the pool
+ * are reset to the template of their model instead of booting.
+ * The functions of a pool can be called from several threads.
+ * This module is part of the static library (make lib), built with THREADS=1. */
+
+#ifndef __MACHINEPOOL_H
+#define __MACHINEPOOL_H
+
+#include <stdint.h>
+#include "motoemulator.h"
+
+typedef struct MachinePool MachinePool;
+
+// Creates a pool whose machines are booted for the given number of frames,
+// with the given date written in the ROM (0 = current date).
+// Returns NULL if there is not enough memory.
+MachinePool *CreateMachinePool(int64_t date, int bootframes);
+// Destroys a pool and its machines (they must all have been released)
+void DestroyMachinePool(MachinePool *p);
+// Returns a booted machine of the given model, without media, with the rendering
+// and the audio output disabled (NULL if there is not enough memory).
+// It must be selected by SetCurrentMachine() to be used, and its video buffer
+// set before enabling its rendering.
+ThomsonMachine *AcquireMachine(MachinePool *p, ThomsonModel model);
+// Gives back a machine to the pool (its media are unloaded)
+void ReleaseMachine(MachinePool *p, ThomsonMachine *m);
+
+#endif /* __MACHINEPOOL_H */
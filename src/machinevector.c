@@ -0,0 +1,282 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Vectorized emulation of several machines in lockstep.
+ * The threads of the pool wait for a new step (generation), then take the
+ * machines to emulate one by one from a shared index, the calling thread
+ * taking part in the step. Nothing is allocated during a step. */
+
+#ifndef THEODORE_THREADS
+#error "The vectorized emulation must be built with THREADS=1"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "machinevector.h"
+
+#define VECTOR_MAX_THREADS 256
+#define JOYSTICK_AXES 10
+
+struct MachineVector
+{
+  int n;
+  ThomsonMachine **machines;
+  uint8_t *frames;                      // n frames
+  unsigned int framesize;
+  unsigned int pitch;
+  unsigned int *rambytes;               // offsets of the observed RAM bytes
+  int nrambytes;
+  uint8_t *ramobs;                      // n x nrambytes bytes
+  bool videoenabled;
+  // step in progress
+  const VectorInput *inputs;
+  int next;                             // next machine to emulate
+  // pool of threads
+  pthread_t threads[VECTOR_MAX_THREADS];
+  int nthreads;                         // threads of the pool (without the calling thread)
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  unsigned int generation;              // number of steps started
+  int running;                          // threads of the pool still in the step
+  bool quit;
+};
+
+static void QueueInput(const VectorInput *input)
+{
+  int i;
+  for (i = 0; i < JOYSTICK_AXES; i++)
+  {
+    QueueJoystick(0, (JoystickAxis) i, (input->joystick >> i) & 1);
+  }
+  for (i = 0; (i < input->nkeys) && (i < VECTOR_MAX_KEYS); i++)
+  {
+    QueueKeyboard(0, input->keys[i].scancode, input->keys[i].down != 0);
+  }
+  if (input->penbutton >= 0)
+  {
+    QueueLightpen(0, input->penx, input->peny, input->penbutton);
+  }
+}
+
+// Emulates one frame of the machine i (selected in the calling thread)
+static void StepMachine(MachineVector *v, int i)
+{
+  const char *ram;
+  uint8_t *obs = v->ramobs + i * v->nrambytes;
+  int k;
+  SetCurrentMachine(v->machines[i]);
+  if (v->inputs != NULL)
+  {
+    QueueInput(&v->inputs[i]);
+  }
+  SetVideoEnabled(v->videoenabled);
+  RunFrame();
+  ElapsedCycles();
+  ram = GetRam();
+  for (k = 0; k < v->nrambytes; k++)
+  {
+    obs[k] = ram[v->rambytes[k]];
+  }
+}
+
+// Emulates the machines not yet taken by another thread
+static void StepMachines(MachineVector *v)
+{
+  int i;
+  while ((i = __sync_fetch_and_add(&v->next, 1)) < v->n)
+  {
+    StepMachine(v, i);
+  }
+}
+
+static void *VectorThread(void *arg)
+{
+  MachineVector *v = arg;
+  unsigned int generation = 0;
+  pthread_mutex_lock(&v->lock);
+  for (;;)
+  {
+    while ((v->generation == generation) && !v->quit)
+    {
+      pthread_cond_wait(&v->start, &v->lock);
+    }
+    if (v->quit) break;
+    generation = v->generation;
+    pthread_mutex_unlock(&v->lock);
+    StepMachines(v);
+    pthread_mutex_lock(&v->lock);
+    if (--v->running == 0)
+    {
+      pthread_cond_signal(&v->done);
+    }
+  }
+  pthread_mutex_unlock(&v->lock);
+  return NULL;
+}
+
+MachineVector *CreateMachineVector(int n, ThomsonModel model, enum VideoPixelFormat format,
+    int64_t date, const unsigned int *rambytes, int nrambytes, int nthreads)
+{
+  ThomsonMachine *current = GetCurrentMachine();
+  MachineVector *v;
+  int i;
+  if ((n <= 0) || (nrambytes < 0)) return NULL;
+  for (i = 0; i < nrambytes; i++)
+  {
+    if (rambytes[i] >= GetModelRamSize(model)) return NULL;
+  }
+  v = calloc(1, sizeof(MachineVector));
+  if (v == NULL) return NULL;
+  pthread_mutex_init(&v->lock, NULL);
+  pthread_cond_init(&v->start, NULL);
+  pthread_cond_init(&v->done, NULL);
+  v->n = n;
+  v->nrambytes = nrambytes;
+  v->videoenabled = true;
+  v->pitch = XBITMAP * ((format == VIDEO_PIXEL_XRGB8888) ? 4 : 2);
+  v->framesize = YBITMAP * v->pitch;
+  v->machines = calloc(n, sizeof(ThomsonMachine *));
+  v->frames = malloc((size_t) n * v->framesize);
+  v->rambytes = malloc((nrambytes + 1) * sizeof(unsigned int));
+  v->ramobs = calloc((size_t) n * nrambytes + 1, 1);
+  if ((v->machines == NULL) || (v->frames == NULL) || (v->rambytes == NULL) || (v->ramobs == NULL))
+  {
+    DestroyMachineVector(v);
+    return NULL;
+  }
+  memcpy(v->rambytes, rambytes, nrambytes * sizeof(unsigned int));
+  for (i = 0; i < n; i++)
+  {
+    v->machines[i] = CreateMachine();
+    if (v->machines[i] == NULL)
+    {
+      SetCurrentMachine(current);
+      DestroyMachineVector(v);
+      return NULL;
+    }
+    SetCurrentMachine(v->machines[i]);
+    SetVideoPixelFormat(format);
+    SetLibRetroVideoBuffer(v->frames + (size_t) i * v->framesize);
+    SetAudioEnabled(false);
+    SetEmulatedDate(date);
+    SetThomsonModel(model);
+    Hardreset();
+  }
+  SetCurrentMachine(current);
+
+  if (nthreads <= 0) nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads > n) nthreads = n;
+  if (nthreads > VECTOR_MAX_THREADS + 1) nthreads = VECTOR_MAX_THREADS + 1;
+  // The calling thread is one of the threads of the step
+  for (i = 0; i < nthreads - 1; i++)
+  {
+    if (pthread_create(&v->threads[i], NULL, VectorThread, v) != 0) break;
+    v->nthreads++;
+  }
+  return v;
+}
+
+void DestroyMachineVector(MachineVector *v)
+{
+  int i;
+  if (v == NULL) return;
+  if (v->nthreads > 0)
+  {
+    pthread_mutex_lock(&v->lock);
+    v->quit = true;
+    pthread_cond_broadcast(&v->start);
+    pthread_mutex_unlock(&v->lock);
+    for (i = 0; i < v->nthreads; i++)
+    {
+      pthread_join(v->threads[i], NULL);
+    }
+  }
+  if (v->machines != NULL)
+  {
+    for (i = 0; i < v->n; i++)
+    {
+      DestroyMachine(v->machines[i]);
+    }
+  }
+  pthread_mutex_destroy(&v->lock);
+  pthread_cond_destroy(&v->start);
+  pthread_cond_destroy(&v->done);
+  free(v->machines);
+  free(v->frames);
+  free(v->rambytes);
+  free(v->ramobs);
+  free(v);
+}
+
+int GetVectorSize(const MachineVector *v)
+{
+  return v->n;
+}
+
+ThomsonMachine *GetVectorMachine(const MachineVector *v, int i)
+{
+  return v->machines[i];
+}
+
+void SetVectorVideoEnabled(MachineVector *v, bool enabled)
+{
+  v->videoenabled = enabled;
+}
+
+void StepMachineVector(MachineVector *v, const VectorInput *inputs)
+{
+  ThomsonMachine *current = GetCurrentMachine();
+  v->inputs = inputs;
+  v->next = 0;
+  if (v->nthreads > 0)
+  {
+    pthread_mutex_lock(&v->lock);
+    v->running = v->nthreads;
+    v->generation++;
+    pthread_cond_broadcast(&v->start);
+    pthread_mutex_unlock(&v->lock);
+  }
+  StepMachines(v);
+  if (v->nthreads > 0)
+  {
+    pthread_mutex_lock(&v->lock);
+    while (v->running > 0)
+    {
+      pthread_cond_wait(&v->done, &v->lock);
+    }
+    pthread_mutex_unlock(&v->lock);
+  }
+  SetCurrentMachine(current);
+}
+
+const uint8_t *GetVectorFrames(const MachineVector *v, unsigned int *framesize, unsigned int *pitch)
+{
+  if (framesize != NULL) *framesize = v->framesize;
+  if (pitch != NULL) *pitch = v->pitch;
+  return v->frames;
+}
+
+const uint8_t *GetVectorRamBytes(const MachineVector *v)
+{
+  return v->ramobs;
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Vectorized emulation: a vector of machines stepped one frame at a time in
+ * lockstep, with one input per machine, on a pool of threads. The frames and
+ * selected bytes of the RAM of all the machines are written after each step in
+ * buffers allocated once, for use as observations by automated players.
+ * This module is part of the static library (make lib), built with THREADS=1. */
+
+#ifndef __MACHINEVECTOR_H
+#define __MACHINEVECTOR_H
+
+#include <stdint.h>
+#include "boolean.h"
+#include "motoemulator.h"
+#include "video.h"
+
+// Max number of keyboard events in the input of a machine for one frame
+#define VECTOR_MAX_KEYS 4
+
+typedef struct MachineVector MachineVector;
+
+// Input of a machine for one frame
+typedef struct
+{
+  uint16_t joystick;                    // bit n set = JoystickAxis n on
+  uint8_t nkeys;                        // number of keyboard events
+  struct
+  {
+    uint8_t scancode;                   // scancode of the emulated model
+    uint8_t down;
+  } keys[VECTOR_MAX_KEYS];              // keyboard events (applied one frame apart)
+  int16_t penx, peny;                   // light pen position
+  int8_t penbutton;                     // light pen button (< 0 = no light pen event)
+} VectorInput;
+
+// Creates n machines of the given model (with the given date written in the
+// ROM, 0 = current date), stepped by nthreads threads (0 = one per processor).
+// After each step, the bytes at the nrambytes offsets of rambytes in the RAM
+// of each machine are copied in the RAM observations.
+// Returns NULL if there is not enough memory or if an offset is out of the RAM of the model.
+MachineVector *CreateMachineVector(int n, ThomsonModel model, enum VideoPixelFormat format,
+    int64_t date, const unsigned int *rambytes, int nrambytes, int nthreads);
+// Destroys the machines and the threads
+void DestroyMachineVector(MachineVector *v);
+// Returns the number of machines
+int GetVectorSize(const MachineVector *v);
+// Returns the machine i, to be selected with SetCurrentMachine() to load a media,
+// reset it... (not during a step)
+ThomsonMachine *GetVectorMachine(const MachineVector *v, int i);
+// Enables or disables the rendering of the frames (default=enabled)
+void SetVectorVideoEnabled(MachineVector *v, bool enabled);
+// Emulates one frame of all the machines, with inputs[i] for the machine i
+// (inputs = NULL: no input event)
+void StepMachineVector(MachineVector *v, const VectorInput *inputs);
+// Frames of the machines: n frames of YBITMAP lines of XBITMAP pixels in a
+// contiguous buffer (framesize = bytes between two frames, pitch = bytes
+// between two lines)
+const uint8_t *GetVectorFrames(const MachineVector *v, unsigned int *framesize, unsigned int *pitch);
+// RAM observations: n x nrambytes bytes
+const uint8_t *GetVectorRamBytes(const MachineVector *v);
+
+#endif /* __MACHINEVECTOR_H */
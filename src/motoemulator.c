@@ -24,12 +24,23 @@
 #include "debugger.h"
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#if defined(__linux__) && !defined(__ANDROID__)
+// The memory of the created machines is shared until written (copy-on-write)
+#define COW_MEMORY
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "6809cpu.h"
+#include "audio.h"
 #include "debugger.h"
 #include "devices.h"
+#include "digest.h"
+#include "machine.h"
 #include "video.h"
 #include "rom/rom_to8.inc"
 #include "rom/rom_to8d.inc"
@@ -43,17 +54,33 @@
 #include "rom/basic-1_memo7.inc"
 #include "rom/basic-128_memo7.inc"
 
-// Screen is refreshed every VBL_NUMBER_MAX vertical blanking intervals.
-// Must be 1 to produce a new frame each time retro_run() is called.
-// If > 1, the virtual keyboard will blink if transparency (alpha) != 255.
-#define VBL_NUMBER_MAX  1
-// Number of keys of the keyboard
-#define KEYBOARDKEY_MAX 84
-#define PALETTE_SIZE    32
+// Min nb of cycles between two keyboard events
+#define KEYBOARD_EVENT_INTERVAL FRAME_CYCLES
+// Min nb of cycles a typed key is applied once read by the emulated computer
+// (the monitors check the key again after a debounce delay)
+#define TYPED_KEY_HOLD (FRAME_CYCLES * 3 / 4)
+// Max nb of cycles waiting for the emulated computer to read a typed key
+#define TYPED_KEY_TIMEOUT (50 * FRAME_CYCLES)
+// Min nb of lines of a frame spent in the keyboard wait loop of the monitor
+// for the computer to be considered as waiting for a key (the loop of BASIC 512
+// calls the monitor and takes about 50 of the 312 lines)
+#define KEY_WAIT_LINES 32
 // Sound level on 6 bits
 #define MAX_SOUND_LEVEL 0x3f
+// Save states: identifier ("THEO") and version of the format
+#define STATE_MAGIC   0x4f454854
+#define STATE_VERSION 2
 
+// En-tete des sauvegardes d'etat
 typedef struct
+{
+  uint32_t magic;     // STATE_MAGIC
+  uint32_t version;   // STATE_VERSION
+  int32_t model;      // ThomsonModel
+  uint32_t ramsize;   // Taille de la RAM sauvegardee a la fin de l'etat
+} StateHeader;
+
+struct SystemRom
 {
   char *basic;        // "BASIC and other embedded software" part of the ROM
   int *basic_patch;   // Patch to apply to the "BASIC and other embedded software" part of the ROM
@@ -63,7 +90,7 @@ typedef struct
   int *disk_drive_monitor_patch; // MO5/MO6: Patch to apply to the disk drive monitor
   bool is_mo;                    // If it is a MO or TO system
   bool is_mo6;                   // If it is a MO6 or a PC128
-} SystemRom;
+};
 
 static SystemRom ROM_TO8 = { to8_basic_rom, to8_basic_patch, to8_monitor_rom, to8_monitor_patch, NULL, NULL, false, false };
 static SystemRom ROM_TO8D = { to8_basic_rom, to8_basic_patch, to8d_monitor_rom, to8d_monitor_patch, NULL, NULL, false, false };
@@ -75,49 +102,133 @@ static SystemRom ROM_PC128 = { pc128_basic128_rom, pc128_basic128_patch, pc128_b
 static SystemRom ROM_TO770 = { NULL, NULL, to770_monitor_rom, to770_monitor_patch, NULL, NULL, false, false };
 static SystemRom ROM_TO7 = { NULL, NULL, to7_monitor_rom, to7_monitor_patch, NULL, NULL, false, false };
 
-static ThomsonModel currentModel = TO8;
-static SystemRom *rom = &ROM_TO8;
+// Images des ROM, partagees par toutes les machines
+static SystemRom *const systemroms[] = { &ROM_TO8, &ROM_TO8D, &ROM_TO9, &ROM_TO9P,
+  &ROM_MO5, &ROM_MO6, &ROM_PC128, &ROM_TO770, &ROM_TO7 };
+
+// Boucle d'attente d'une touche apres le demarrage (menu ou BASIC), par modele
+typedef struct
+{
+  unsigned short start;  // adresse de la premiere instruction
+  unsigned short length; // taille de la boucle
+} KeyWaitLoop;
+
+static const KeyWaitLoop keywaitloops[] = {
+  { 0x2fe6, 4 },    // TO8: menu
+  { 0x2fe6, 4 },    // TO8D: menu
+  { 0x2b48, 2 },    // TO9: menu
+  { 0x2fe6, 4 },    // TO9+: menu
+  { 0xf1da, 0x32 }, // MO5: BASIC
+  { 0xf475, 4 },    // MO6: menu
+  { 0xf475, 4 },    // PC128: menu
+  { 0xfbc3, 2 },    // TO7: menu
+  { 0xfbc3, 2 }     // TO7/70: menu
+};
+
+// Boucle d'attente d'une commande de BASIC 512 et BASIC 128, lances depuis le
+// menu (BASIC 1 attend dans une boucle du moniteur executee aussi avant le menu)
+static const KeyWaitLoop basicwaitloops[] = {
+  { 0x2cc8, 0x18 }, // TO8: BASIC 512
+  { 0x2cc8, 0x18 }, // TO8D: BASIC 512
+  { 0x2bec, 0x0c }, // TO9: BASIC 128
+  { 0x2cc8, 0x18 }, // TO9+: BASIC 512
+  { 0, 0 },         // MO5
+  { 0, 0 },         // MO6
+  { 0, 0 },         // PC128
+  { 0, 0 },         // TO7
+  { 0, 0 }          // TO7/70
+};
+
+// Verification des compteurs et index d'un etat charge, utilises comme positions
+// dans des tableaux (avant la definition des macros qui portent les memes noms)
+static bool IsMachineStateValid(const MachineState *s)
+{
+  int i;
+  if ((s->ninputevents < 0) || (s->ninputevents > INPUT_QUEUE_SIZE)
+      || (s->ntypedkeys < 0) || (s->ntypedkeys > TYPED_KEYS_SIZE)
+      || (s->typedkey < -1) || (s->typedkey >= KEYBOARDKEY_MAX)
+      || (s->videolinecycle < 0) || (s->videolinecycle >= 64)
+      || (s->videolinenumber < 0) || (s->videolinenumber >= 312)
+      || (s->bordercolor < 0) || (s->bordercolor >= 20))
+  {
+    return false;
+  }
+  for (i = 0; i < s->ntypedkeys; i++)
+  {
+    if ((s->typedkeys[i] & 0xff) >= KEYBOARDKEY_MAX) return false;
+  }
+  for (i = 0; i < s->ninputevents; i++)
+  {
+    if ((s->inputevents[i].type == INPUT_KEYBOARD)
+        && ((s->inputevents[i].a < 0) || (s->inputevents[i].a >= KEYBOARDKEY_MAX))) return false;
+  }
+  return true;
+}
+
+// global variables (of the current machine)
+#define currentModel (machine->currentModel)
+#define emulateddate (machine->emulateddate) //date ecrite en ROM (0 = date courante)
+#define rom (machine->rom)
 
 // memory
-char car[CARTRIDGE_MEM_SIZE];   //espace cartouche 4x16K
-char ram[RAM_SIZE];             //ram 512K
-char port[IO_MEM_SIZE];         //ports d'entree/sortie (0xE7C0 -> 0xE7FF)
-static char x7da[PALETTE_SIZE]; //stockage de la palette de couleurs
+#define car (machine->car)                   //espace cartouche 4x16K
+#define ram (machine->ram)                   //ram 512K
+#define port (machine->state.port)           //ports d'entree/sortie (0xE7C0 -> 0xE7FF)
+#define cartype (machine->cartype)           //type de cartouche (0=simple 1=switch bank, 2=os-9)
+#define carflags (machine->state.carflags)   //bits0,1,4=bank, 2=cart-enabled, 3=write-enabled
+#define x7da (machine->state.x7da)           //stockage de la palette de couleurs
+#define ramclock (machine->ramclock)         //numero du point de controle courant des ecritures en RAM
+#define rampageclock (machine->rampageclock) //point de controle de la derniere ecriture de chaque page
 // pointers
-char *pagevideo;            //pointeur page video affichee
-static char *ramvideo;      //pointeur couleurs ou formes
-static char *ramuser;       //pointeur ram utilisateur fixe
-static char *rambank;       //pointeur banque ram utilisateur
-static char *romsys;        //pointeur rom systeme
-static char *rombank;       //pointeur banque rom ou cartouche
-//flags cartouche
-int cartype;         //type de cartouche (0=simple, 1=switch bank, 2=os-9)
-int carflags = 0;    //bits0,1,4=bank, 2=cart-enabled, 3=write-enabled
+#define pagevideo (machine->pagevideo)       //pointeur page video affichee
+#define ramvideo (machine->ramvideo)         //pointeur couleurs ou formes
+#define ramuser (machine->ramuser)           //pointeur ram utilisateur fixe
+#define rambank (machine->rambank)           //pointeur banque ram utilisateur
+#define romsys (machine->romsys)             //pointeur rom systeme
+#define rombank (machine->rombank)           //pointeur banque rom ou cartouche
 //keyboard, joysticks, mouse
-static int touche[KEYBOARDKEY_MAX]; //etat touches
-static int capslock;         //1=capslock, 0 sinon
-static int joysposition;     //position des manches
-static int joysaction;       //position des boutons d'action
-int xpen, ypen;              //lightpen coordinates
-int penbutton;               //lightpen button state
+#define touche (machine->state.touche)             //etat touches
+#define capslock (machine->state.capslock)         //1=capslock, 0 sinon
+#define joysposition (machine->state.joysposition) //position des manches
+#define joysaction (machine->state.joysaction)     //position des boutons d'action
+#define xpen (machine->state.xpen)                 //coordonnees et bouton du crayon optique
+#define ypen (machine->state.ypen)
+#define penbutton (machine->state.penbutton)
 //affichage
-int videolinecycle;         //compteur ligne (0-63)
-int videolinenumber;        //numero de ligne video affichee (0-311)
-static int vblnumber;       //compteur du nombre de vbl avant affichage
-static int displayflag;     //indicateur pour l'affichage
-int bordercolor;            //couleur de la bordure de l'écran
+#define displayflag (machine->state.displayflag) //indicateur pour l'affichage
+#define videolinecycle (machine->state.videolinecycle)   //compteur ligne (0-63)
+#define videolinenumber (machine->state.videolinenumber) //numero de ligne video affichee (0-311)
+#define bordercolor (machine->state.bordercolor)         //couleur de la bordure de l'ecran
+#define videoenabled (machine->videoenabled)     //indicateur de rendu de l'affichage
+#define Displaysegment (machine->video.displaysegment)
+#define Nextline (machine->video.nextline)
 //divers
-static int sound;                  //niveau du haut-parleur
-static int mute;                   //mute flag
-static int timer6846;       //compteur du timer 6846
-static int latch6846;       //registre latch du timer 6846
-static int keyb_irqcount;   //nombre de cycles avant la fin de l'irq clavier
-static int timer_irqcount;  //nombre de cycles avant la fin de l'irq timer
-//reserved data in serialization for future use
-static int reserved1 = 0;
-static int reserved2 = 0;
-static int reserved3 = 0;
-static int reserved4 = 0;
+#define sound (machine->state.sound)          //niveau du haut-parleur
+#define mute (machine->state.mute)            //mute flag
+#define framecycles (machine->framecycles)    //nombre de cycles executes depuis le debut de la trame audio
+#define audioenabled (machine->audioenabled)  //transmission des changements de niveau au module audio
+//evenements d'entree en attente, tries par cycle
+#define inputevents (machine->state.inputevents)
+#define ninputevents (machine->state.ninputevents)
+#define lastkeycycle (machine->state.lastkeycycle)     //cycle du dernier evenement clavier en attente
+#define typedkeys (machine->state.typedkeys)           //touches tapees en attente
+#define ntypedkeys (machine->state.ntypedkeys)
+#define typedkey (machine->state.typedkey)             //derniere touche tapee (-1 = aucune)
+#define keyreads (machine->state.keyreads)             //nombre de lectures de cette touche
+#define typingcycles (machine->state.typingcycles)     //nombre de cycles depuis son application ou sa lecture
+#define keywaitlines (machine->state.keywaitlines)     //lignes de la trame dans la boucle d'attente d'une touche
+#define waitingforkey (machine->state.waitingforkey)   //attente d'une touche pendant la trame precedente
+#define inputfilter (machine->inputfilter)             //filtre des evenements d'entree
+#define timer6846 (machine->state.timer6846)           //compteur du timer 6846
+#define latch6846 (machine->state.latch6846)           //registre latch du timer 6846
+#define keyb_irqcount (machine->state.keyb_irqcount)   //nombre de cycles avant la fin de l'irq clavier
+#define timer_irqcount (machine->state.timer_irqcount) //nombre de cycles avant la fin de l'irq timer
+
+// Writes in RAM, keeping track of the modified page
+#define RAMWRITE(p, c) { char *rp = (p); *rp = (c); rampageclock[(rp - ram) >> RAM_PAGE_SHIFT] = ramclock; }
+// Same as RAMWRITE for a pointer that may point outside the RAM
+#define MEMWRITE(p, c) { char *rp = (p); size_t ro = (size_t) ((uintptr_t) rp - (uintptr_t) ram); \
+                         *rp = (c); if (ro < RAM_SIZE) rampageclock[ro >> RAM_PAGE_SHIFT] = ramclock; }
 
 //Forward declarations
 static char MgetTo(unsigned short a);
@@ -127,8 +238,8 @@ static void MputMo(unsigned short a, char c);
 static char MgetTo7(unsigned short a);
 static void MputTo7(unsigned short a, char c);
 
-void (*selectVideoRam)(void);
-void (*selectRomBank)(void);
+#define selectVideoRam (machine->selectVideoRam)
+#define selectRomBank (machine->selectRomBank)
 
 //Table de conversion scancode TO9 --> code ASCII
 const int to9key[0xa0] =
@@ -203,6 +314,28 @@ int16_t GetAudioSample(void)
   return mute ? 0 : (sound * 65535 / MAX_SOUND_LEVEL) - (65536 / 2);
 }
 
+// Transmission du niveau du haut-parleur au module audio
+static void Updatesound(void)
+{
+  if (audioenabled)
+  {
+    AudioLevel(framecycles, GetAudioSample());
+  }
+}
+
+void SetAudioEnabled(bool enabled)
+{
+  audioenabled = enabled;
+  Updatesound();
+}
+
+int ElapsedCycles(void)
+{
+  int cycles = framecycles;
+  framecycles = 0;
+  return cycles;
+}
+
 void SetThomsonModel(ThomsonModel model)
 {
   if (model != currentModel)
@@ -252,6 +385,24 @@ ThomsonModel GetThomsonModel(void)
   return currentModel;
 }
 
+// Checksum des patchs de la ROM //////////////////////////////////////////////
+static uint64_t hash_patch(const int patch[], uint64_t seed)
+{
+  int i, n;
+  if (patch == NULL) return seed;
+  i = 0;
+  while((n = patch[i++])) i += n + 2;
+  return Hash64(patch, i * sizeof(int), seed);
+}
+
+uint64_t GetRomChecksum(void)
+{
+  uint64_t checksum = currentModel;
+  checksum = hash_patch(rom->basic_patch, checksum);
+  checksum = hash_patch(rom->monitor_patch, checksum);
+  return hash_patch(rom->disk_drive_monitor_patch, checksum);
+}
+
 // Emulation du clavier TO8/TO9 ///////////////////////////////////////////////
 void keyboard(int scancode, bool down)
 {
@@ -287,8 +438,8 @@ void keyboard(int scancode, bool down)
   }
   if (currentModel == TO8 || currentModel == TO8D)
   {
-    rom->monitor[0x30f8] = scancode | i;         //scancode + indicateur de touche SHIFT
-    rom->monitor[0x3125] = touche[0x53] ? 0 : 1; //indicateur de touche CTRL
+    machine->keybank[0x10f8] = scancode | i;         //scancode + indicateur de touche SHIFT ($30F8 en ROM)
+    machine->keybank[0x1125] = touche[0x53] ? 0 : 1; //indicateur de touche CTRL ($3125 en ROM)
     port[0x08] |= 0x01; //bit 0 de E7C8 = 1 (touche enfoncee)
     port[0x00] |= 0x82; //bit CP1 = interruption clavier
     keyb_irqcount = 500000; //positionne le signal d'irq pour 500 ms maximum
@@ -310,7 +461,107 @@ void keyboard(int scancode, bool down)
   }
 }
 
+// Lecture de la touche tapee par l'ordinateur emule /////////////////////////
+static void Typedkeyread(void)
+{
+  if(keyreads++ == 0) typingcycles = 0;
+}
+
+// Lecture de l'etat d'une touche par l'ordinateur emule ////////////////////
+static char Readkey(int scancode)
+{
+  if(scancode == typedkey) Typedkeyread();
+  return touche[scancode];
+}
+
+// Touches SHIFT, BASIC et CNT (lues seulement avec une autre touche) ///////
+static bool Modifierkey(int scancode)
+{
+  switch(currentModel)
+  {
+    case MO5: case TO7: case TO7_70:
+      return (scancode == 0x38) || (scancode == 0x39) || (scancode == 0x35);
+    case MO6: case PC128:
+      return (scancode == 0x07) || (scancode == 0x0f) || (scancode == 0x2e);
+    default:
+      return scancode > 0x4f;
+  }
+}
+
+// Buffer des touches du moniteur TO8/TO8D plein ////////////////////////////
+// (rempli par l'interruption clavier, une touche de plus serait perdue)
+static bool Keybufferfull(void)
+{
+  int size;
+  if((currentModel != TO8) && (currentModel != TO8D)) return false;
+  //index de lecture ($605E), index d'ecriture ($6067) et taille ($607B)
+  size = ramuser[0x607b] & 0xff;
+  return (size > 0) && (((ramuser[0x6067] & 0xff) + 1) % size == (ramuser[0x605e] & 0xff));
+}
+
+// Touches tapees : chacune est appliquee quand la precedente a ete lue ///////
+static void Typekey(void)
+{
+  int i, key;
+  typingcycles += 64;
+  if(((keyreads == 0) || (typingcycles < TYPED_KEY_HOLD)) && (typingcycles < TYPED_KEY_TIMEOUT)) return;
+  if((typedkeys[0] & 0x100) && Keybufferfull() && (typingcycles < TYPED_KEY_TIMEOUT)) return;
+  key = typedkeys[0];
+  ntypedkeys--;
+  for (i = 0; i < ntypedkeys; i++) typedkeys[i] = typedkeys[i + 1];
+  typedkey = key & 0xff;
+  keyreads = 0;
+  typingcycles = 0;
+  // pas de lecture a attendre pour les touches SHIFT/CNT, ni pour les relachements
+  // sur TO8/TO9 (seul le code de la touche enfoncee est lu par le moniteur) :
+  // la touche suivante peut alors etre enfoncee immediatement
+  if (Modifierkey(typedkey))
+  {
+    keyreads = 1;
+  }
+  else if (!(key & 0x100) && !rom->is_mo && (currentModel != TO7) && (currentModel != TO7_70))
+  {
+    keyreads = 1;
+    typingcycles = TYPED_KEY_HOLD;
+  }
+  keyboard(typedkey, (key & 0x100) != 0);
+}
+
 // Selection de banques memoire //////////////////////////////////////////////
+// Banques des ROM BASIC (16K) et moniteur (8K) des TO : les banques modifiees
+// par l'emulation (date, code de la touche) sont des copies propres a la machine
+static bool HasDateInRom(void)
+{
+  return (currentModel == TO8) || (currentModel == TO8D) || (currentModel == TO9P);
+}
+
+static bool HasKeyInRom(void)
+{
+  return (currentModel == TO8) || (currentModel == TO8D);
+}
+
+static char *Basicbank(int n)
+{
+  if ((n == ROM_DATE_BANK) && HasDateInRom()) return machine->datebank;
+  return rom->basic + (n << 14);
+}
+
+static char *Monitorbank(int n)
+{
+  if ((n == ROM_KEY_BANK) && HasKeyInRom()) return machine->keybank;
+  return rom->monitor + (n << 13);
+}
+
+// Changement de la couleur du cadre /////////////////////////////////////////
+static void Setbordercolor(int c)
+{
+  if (c != bordercolor)
+  {
+    bordercolor = c;
+    MarkDisplayDirty();
+  }
+}
+
 static void selectVideoRamTo(void)
 {
   int nsystbank;  //numero banque systeme (00-01)
@@ -320,7 +571,7 @@ static void selectVideoRamTo(void)
   ramvideo = ram - 0x4000 + (nvideopage << 13);
   nsystbank = (currentModel != TO9) ? (port[0x03] & 0x10) >> 4 : 0;
   // The "monitor" software is mapped in memory starting at address 0xe000
-  romsys = rom->monitor - 0xe000 + (nsystbank << 13);
+  romsys = Monitorbank(nsystbank) - 0xe000;
 }
 
 static void selectVideoRamTo7(void)
@@ -333,12 +584,12 @@ static void selectVideoRamTo7(void)
   romsys = rom->monitor - 0xe800;
   if (currentModel == TO7)
   {
-    bordercolor = (port[0x03] >> 4) & 0x07;
+    Setbordercolor((port[0x03] >> 4) & 0x07);
   }
   else
   {
     // TO7/70 (Pastel + BGR)
-    bordercolor = ((port[0x03] >> 4) & 0x07) | ((~port[0x03] & 0x04) << 1);
+    Setbordercolor(((port[0x03] >> 4) & 0x07) | ((~port[0x03] & 0x04) << 1));
   }
 }
 
@@ -349,7 +600,7 @@ static void selectVideoRamMo5(void)
   ramvideo = ram + (nvideopage << 13);
   // The "monitor" software is mapped in memory starting at address 0xf000
   romsys = rom->monitor - 0xf000;
-  bordercolor = (port[0] >> 1) & 0x0f;
+  Setbordercolor((port[0] >> 1) & 0x0f);
 }
 
 static void selectVideoRamMo6(void)
@@ -416,7 +667,7 @@ static void selectRomBankTo(void)
     else if (port[0x03] & 0x04)
     {
       nrombank = carflags & 3;
-      rombank = rom->basic + (nrombank << 14);
+      rombank = Basicbank(nrombank);
     }
     else
     {
@@ -504,9 +755,14 @@ static void SwitchMemo5Bank(int a)
 
 static void videopage_bordercolor(char c)
 {
+  char *page = ram + ((c & 0xc0) << 8);
   port[0x1d] = c;
-  pagevideo = ram + ((c & 0xc0) << 8);
-  bordercolor = c & 0x0f;
+  if (page != pagevideo)
+  {
+    pagevideo = page;
+    MarkDisplayDirty();
+  }
+  Setbordercolor(c & 0x0f);
 }
 
 // Selection video ////////////////////////////////////////////////////////////
@@ -604,6 +860,7 @@ void Initprog(void)
     ramuser = ram + 0x2000;
     SetVideoMode(VIDEO_320_16_MO5);
     pagevideo = ram;
+    MarkDisplayDirty();
     Mputc = MputMo;
     Mgetc = MgetMo;
     selectVideoRam = selectVideoRamMo5;
@@ -663,35 +920,172 @@ static void patch_rom(char rom_data[], int patch[])
   }
 }
 
+// Patch of the ROM images of all the models /////////////////////////////////
+static void PatchRoms(void)
+{
+  static bool patched = false;
+  unsigned int i;
+  if (patched) return;
+  for (i = 0; i < sizeof(systemroms) / sizeof(systemroms[0]); i++)
+  {
+    const SystemRom *r = systemroms[i];
+    if ((r->basic != NULL) && (r->basic_patch != NULL))
+    {
+      patch_rom(r->basic, r->basic_patch);
+    }
+    if ((r->monitor != NULL) && (r->monitor_patch != NULL))
+    {
+      patch_rom(r->monitor, r->monitor_patch);
+    }
+    if ((r->disk_drive_monitor != NULL) && (r->disk_drive_monitor_patch != NULL))
+    {
+      patch_rom(r->disk_drive_monitor, r->disk_drive_monitor_patch);
+    }
+  }
+  patched = true;
+}
+
 // Write the current date in the ROM //////////////////////////////////////////
 static void set_current_date(void)
 {
   time_t curtime;
   struct tm *loctime;
-  if (currentModel == TO8 || currentModel == TO8D || currentModel == TO9P)
+#ifdef THEODORE_THREADS
+  struct tm tmbuffer;
+#endif
+  //la banque 3 de la rom BASIC ($C000 -> $FFFF) est une copie propre a la machine
+  char *bank = machine->datebank - 0xc000;
+  if (HasDateInRom())
     {
       //en rom : remplacer jj-mm-aa par la date courante
-      curtime = time(NULL);
+      curtime = (emulateddate != 0) ? (time_t) emulateddate : time(NULL);
+#ifdef THEODORE_THREADS
+      //les machines peuvent demarrer en parallele (localtime n'est pas reentrante)
+      loctime = localtime_r(&curtime, &tmbuffer);
+#else
       loctime = localtime(&curtime);
-      strftime(rom->basic + 0xeb90, 9, "%d-%m-%y", loctime);
-      rom->basic[0xeb98] = 0x1f;
+#endif
+      strftime(bank + 0xeb90, 9, "%d-%m-%y", loctime);
+      bank[0xeb98] = 0x1f;
       //en rom : au reset initialiser la date courante
       //24E2 8E2B90  LDX  #$2B90
       //24E5 BD29C8  BSR  $29C8
-      rom->basic[0xe4e2] = 0x8e; rom->basic[0xe4e3] = 0x2b;
-      rom->basic[0xe4e4] = 0x90; rom->basic[0xe4e5] = 0xbd;
-      rom->basic[0xe4e6] = 0x29; rom->basic[0xe4e7] = 0xc8;
+      bank[0xe4e2] = 0x8e; bank[0xe4e3] = 0x2b;
+      bank[0xe4e4] = 0x90; bank[0xe4e5] = 0xbd;
+      bank[0xe4e6] = 0x29; bank[0xe4e7] = 0xc8;
     }
 }
 
+void SetEmulatedDate(int64_t date)
+{
+  emulateddate = date;
+}
+
+// Tracking of RAM modifications ////////////////////////////////////////////
+unsigned int RamCheckpoint(void)
+{
+  return ramclock++;
+}
+
+bool IsRamPageModified(int page, unsigned int checkpoint)
+{
+  return rampageclock[page] > checkpoint;
+}
+
+void MarkRamPageModified(int page)
+{
+  rampageclock[page] = ramclock;
+}
+
+void MarkRamModified(void)
+{
+  int i;
+  for (i = 0; i < RAM_PAGE_NUMBER; i++)
+  {
+    rampageclock[i] = ramclock;
+  }
+}
+
 // Hardreset of the emulated computer /////////////////////////////////////////
-void Hardreset(void)
+// Etat de la RAM a la mise sous tension
+static void PowerOnRam(char *mem)
 {
   unsigned int i;
-  for(i = 0; i < sizeof(ram); i++)
+  for(i = 0; i < RAM_SIZE; i++)
   {
-    ram[i] = -((i & 0x80) >> 7);
+    mem[i] = -((i & 0x80) >> 7);
   }
+}
+
+#ifdef COW_MEMORY
+// RAM a la mise sous tension, partagee par les machines creees
+static int ramfd = -1;
+
+static void CreateRamFile(void)
+{
+  char *p;
+#ifdef SYS_memfd_create
+  ramfd = syscall(SYS_memfd_create, "theodore-ram", 0);
+#endif
+  if (ramfd < 0) return;
+  if ((ftruncate(ramfd, RAM_SIZE) != 0)
+      || ((p = mmap(NULL, RAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, ramfd, 0)) == MAP_FAILED))
+  {
+    close(ramfd);
+    ramfd = -1;
+    return;
+  }
+  PowerOnRam(p);
+  munmap(p, RAM_SIZE);
+}
+
+// Projection privee du fichier fd (ou de pages nulles si fd < 0) :
+// les pages sont partagees jusqu'a leur premiere ecriture
+static char *MapMemory(int fd, size_t size)
+{
+  void *p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | ((fd < 0) ? MAP_ANONYMOUS : 0), fd, 0);
+  return (p == MAP_FAILED) ? NULL : p;
+}
+
+// Abandon des copies privees des pages : elles retrouvent leur contenu initial
+static bool UnshareMemory(char *mem, size_t size)
+{
+  return madvise(mem, size, MADV_DONTNEED) == 0;
+}
+#endif
+
+// Reinitialisation de la RAM
+static void ResetMemory(void)
+{
+#ifdef COW_MEMORY
+  if (machine->mappedmemory && UnshareMemory(ram, RAM_SIZE)) return;
+#endif
+  PowerOnRam(ram);
+}
+
+// Reinitialisation de l'espace cartouche
+static void ResetCartridge(void)
+{
+#ifdef COW_MEMORY
+  if (machine->mappedmemory && UnshareMemory(car, CARTRIDGE_MEM_SIZE)) return;
+#endif
+  memset(car, 0, CARTRIDGE_MEM_SIZE);
+}
+
+void Hardreset(void)
+{
+  unsigned int i;
+  ResetMemory();
+  MarkRamModified();
+  ninputevents = 0;
+  lastkeycycle = -KEYBOARD_EVENT_INTERVAL;
+  ntypedkeys = 0;
+  typedkey = -1;
+  keyreads = 0;
+  typingcycles = 0;
+  keywaitlines = 0;
+  waitingforkey = 0;
   for(i = 0; i < sizeof(port); i++)
   {
     port[i] = 0;
@@ -699,22 +1093,18 @@ void Hardreset(void)
   // Reset cartridge space only if no cartridge is present
   if (carflags == 0)
   {
-    memset(car, 0, CARTRIDGE_MEM_SIZE);
+    ResetCartridge();
   }
   RewindTape();
 
-  // Patch the ROM
-  if ((rom->basic != NULL) && (rom->basic_patch != NULL))
+  // Copy the ROM banks written by the emulation (the ROM is patched by InitMachines)
+  if (HasDateInRom())
   {
-    patch_rom(rom->basic, rom->basic_patch);
+    memcpy(machine->datebank, rom->basic + (ROM_DATE_BANK << 14), ROM_DATE_BANK_SIZE);
   }
-  if ((rom->monitor != NULL) && (rom->monitor_patch != NULL))
+  if (HasKeyInRom())
   {
-    patch_rom(rom->monitor, rom->monitor_patch);
-  }
-  if ((rom->disk_drive_monitor != NULL) && (rom->disk_drive_monitor_patch != NULL))
-  {
-    patch_rom(rom->disk_drive_monitor, rom->disk_drive_monitor_patch);
+    memcpy(machine->keybank, rom->monitor + (ROM_KEY_BANK << 13), ROM_KEY_BANK_SIZE);
   }
   // Set the current date
   set_current_date();
@@ -723,23 +1113,156 @@ void Hardreset(void)
   timer_irqcount = 0;
   videolinecycle = 0;
   videolinenumber = 0;
-  vblnumber = 0;
   InitPalette();
   Initprog();
   latch6846 = 65535;
   timer6846 = 65535;
   sound = 0;
   mute = 0;
+  Updatesound();
   penbutton = 0;
   capslock = 1;
 }
 
+// Mise a jour de l'indicateur pour l'affichage ///////////////////////////////
+static void Updatedisplayflag(void)
+{
+  displayflag = (videoenabled && (videolinenumber > 47) && (videolinenumber < 264));
+}
+
+void SetVideoEnabled(bool enabled)
+{
+  if (enabled && !videoenabled)
+  {
+    // The beam went on without rendering: the rendering restarts at its current position
+    ResyncVideoBeam();
+    MarkDisplayDirty();
+  }
+  videoenabled = enabled;
+  Updatedisplayflag();
+}
+
 // Timer control /////////////////////////////////////////////////////////////
 static void Timercontrol(void)
 {
   if(port[0x05] & 0x01) timer6846 = latch6846 << 3;
 }
 
+// File des evenements d'entree //////////////////////////////////////////////
+static void Applyinputevent(const InputEvent *e)
+{
+  switch (e->type)
+  {
+    case INPUT_KEYBOARD: keyboard(e->a, e->b); break;
+    case INPUT_JOYSTICK: Joysemul(e->a, e->b); break;
+    case INPUT_LIGHTPEN: xpen = e->a; ypen = e->b; penbutton = e->c; break;
+  }
+}
+
+static void Queueinputevent(int cycle, InputEventType type, int a, int b, int c)
+{
+  InputEvent e;
+  int i;
+  e.cycle = cycle; e.type = type; e.a = a; e.b = b; e.c = c;
+  if (ninputevents == INPUT_QUEUE_SIZE)
+  {
+    // File pleine : application immediate
+    Applyinputevent(&e);
+    return;
+  }
+  // Insertion apres les evenements de cycle inferieur ou egal
+  for (i = ninputevents; (i > 0) && (inputevents[i - 1].cycle > cycle); i--)
+  {
+    inputevents[i] = inputevents[i - 1];
+  }
+  inputevents[i] = e;
+  ninputevents++;
+}
+
+void SetInputFilter(InputFilter filter)
+{
+  inputfilter = filter;
+}
+
+void QueueKeyboard(int cycle, int scancode, bool down)
+{
+  if ((inputfilter != NULL) && !inputfilter(INPUT_KEYBOARD, cycle, scancode, down, 0)) return;
+  if (cycle < lastkeycycle + KEYBOARD_EVENT_INTERVAL)
+  {
+    cycle = lastkeycycle + KEYBOARD_EVENT_INTERVAL;
+  }
+  if (cycle < 0) cycle = 0;
+  lastkeycycle = cycle;
+  Queueinputevent(cycle, INPUT_KEYBOARD, scancode, down, 0);
+}
+
+void TypeKeyboard(int scancode, bool down)
+{
+  if ((inputfilter != NULL) && !inputfilter(INPUT_KEYBOARD, 0, scancode, down, 1)) return;
+  if (ntypedkeys == TYPED_KEYS_SIZE) return;
+  if ((ntypedkeys == 0) && (typedkey < 0))
+  {
+    //premiere touche : appliquee immediatement
+    keyreads = 1;
+    typingcycles = TYPED_KEY_HOLD;
+  }
+  typedkeys[ntypedkeys++] = scancode | (down ? 0x100 : 0);
+}
+
+bool IsTyping(void)
+{
+  return ntypedkeys > 0;
+}
+
+bool IsWaitingForKey(void)
+{
+  return waitingforkey != 0;
+}
+
+void QueueJoystick(int cycle, JoystickAxis axis, bool isOn)
+{
+  if ((inputfilter != NULL) && !inputfilter(INPUT_JOYSTICK, cycle, axis, isOn, 0)) return;
+  Queueinputevent(cycle, INPUT_JOYSTICK, axis, isOn, 0);
+}
+
+void QueueLightpen(int cycle, int x, int y, int button)
+{
+  if ((inputfilter != NULL) && !inputfilter(INPUT_LIGHTPEN, cycle, x, y, button)) return;
+  Queueinputevent(cycle, INPUT_LIGHTPEN, x, y, button);
+}
+
+// Execution jusqu'a la fin de la trame video ////////////////////////////////
+void RunFrame(void)
+{
+  int framelength = FRAME_CYCLES - videolinenumber * 64 - videolinecycle;
+  int elapsed = 0;
+  int i, n;
+  // Application des evenements d'entree de la trame a leur cycle
+  for (n = 0; (n < ninputevents) && (inputevents[n].cycle < framelength); n++)
+  {
+    if (inputevents[n].cycle > elapsed)
+    {
+      elapsed = inputevents[n].cycle + Run(inputevents[n].cycle - elapsed);
+    }
+    Applyinputevent(&inputevents[n]);
+  }
+  // Run() traite les fins de ligne et de trame avant de rendre la main
+  if (elapsed < framelength)
+  {
+    elapsed = framelength + Run(framelength - elapsed);
+  }
+  // Les evenements restants sont pour les trames suivantes
+  for (i = n; i < ninputevents; i++)
+  {
+    inputevents[i - n] = inputevents[i];
+    inputevents[i - n].cycle -= elapsed;
+    if (inputevents[i - n].cycle < 0) inputevents[i - n].cycle = 0;
+  }
+  ninputevents -= n;
+  lastkeycycle -= elapsed;
+  if (lastkeycycle < -KEYBOARD_EVENT_INTERVAL) lastkeycycle = -KEYBOARD_EVENT_INTERVAL;
+}
+
 // Execution n cycles processeur 6809 ////////////////////////////////////////
 int Run(int ncyclesmax)
 {
@@ -754,6 +1277,7 @@ int Run(int ncyclesmax)
     opcycles = Run6809();
     if(opcycles < 0) {RunIoOpcode(-opcycles); opcycles = 64;}
     ncycles += opcycles;
+    framecycles += opcycles;
     videolinecycle += opcycles;
     if(displayflag) Displaysegment();
     // Attente d'une fin de ligne
@@ -761,6 +1285,10 @@ int Run(int ncyclesmax)
     {
       videolinecycle -= 64;
       if(displayflag) Nextline();
+      if(((unsigned short)(dc6809_pc - keywaitloops[currentModel].start) < keywaitloops[currentModel].length)
+      || ((unsigned short)(dc6809_pc - basicwaitloops[currentModel].start) < basicwaitloops[currentModel].length))
+        keywaitlines++;
+      if(ntypedkeys > 0) Typekey();
       // Attente d'une fin de trame
       if(++videolinenumber > 311)
         //valeurs de videolinenumber :
@@ -769,10 +1297,11 @@ int Run(int ncyclesmax)
         //256-263 bord bas, 264-311 hors ecran
       {
         videolinenumber -= 312;
-        if(++vblnumber >= VBL_NUMBER_MAX) vblnumber = 0;
         if (rom->is_mo) Irq();
+        waitingforkey = (keywaitlines >= KEY_WAIT_LINES);
+        keywaitlines = 0;
       }
-      displayflag = ((vblnumber == 0) && (videolinenumber > 47) && (videolinenumber < 264));
+      Updatedisplayflag();
     }
     if (!rom->is_mo)
     {
@@ -815,7 +1344,7 @@ static void MputTo(unsigned short a, char c)
         //quand la rom est recouverte par la ram, les 2 segments de 8 Ko sont inverses
         if(!(port[0x26] & 0x20)) {carflags = (carflags & 0xfc) | (a & 3); selectRomBank();}
         if((port[0x26] & 0x60) != 0x60) return;
-        if(port[0x26] & 0x20) rombank[a + 0x2000] = c; else rombank[a] = c; return;
+        if(port[0x26] & 0x20) RAMWRITE(rombank + a + 0x2000, c) else RAMWRITE(rombank + a, c) return;
       }
       else
       {
@@ -824,16 +1353,18 @@ static void MputTo(unsigned short a, char c)
         return;
       }
     case 0x2: case 0x3: if((port[0x26] & 0x60) != 0x60) return;
-    if(port[0x26] & 0x20) rombank[a - 0x2000] = c; else rombank[a] = c; return;
-    case 0x4: case 0x5: ramvideo[a] = c; return;
-    case 0x6: case 0x7: case 0x8: case 0x9: ramuser[a] = c; return;
-    case 0xa: case 0xb: case 0xc: case 0xd: rambank[a] = c; return;
+    if(port[0x26] & 0x20) MEMWRITE(rombank + a - 0x2000, c) else MEMWRITE(rombank + a, c) return;
+    case 0x4: case 0x5: RAMWRITE(ramvideo + a, c) return;
+    case 0x6: case 0x7: case 0x8: case 0x9: RAMWRITE(ramuser + a, c) return;
+    case 0xa: case 0xb: case 0xc: case 0xd: RAMWRITE(rambank + a, c) return;
     case 0xe:
       switch(a)
       {
         case 0xe7c0: port[0x00] = c; return;
-        case 0xe7c1: port[0x01] = c; mute = c & 8; return;
-        case 0xe7c3: port[0x03] = (c & 0x3d); if((c & 0x20) == 0) keyb_irqcount = 0;
+        case 0xe7c1: port[0x01] = c; mute = c & 8; Updatesound(); return;
+        case 0xe7c3: port[0x03] = (c & 0x3d);
+          //acquittement de l'interruption clavier (le code de la touche a ete lu)
+          if((c & 0x20) == 0) {if(keyb_irqcount > 0) Typedkeyread(); keyb_irqcount = 0;}
         selectVideoRam(); selectRomBank(); return;
         case 0xe7c5: port[0x05] = c; Timercontrol(); return; //controle timer
         case 0xe7c6: latch6846 = (latch6846 & 0xff) | ((c & 0xff) << 8); return;
@@ -845,7 +1376,7 @@ static void MputTo(unsigned short a, char c)
         //e7ce= registre de controle port A (CRA)
         //e7cf= registre de controle port B (CRB)
         case 0xe7cc: port[0x0c] = c; return;
-        case 0xe7cd: if(port[0x0f] & 4) sound = c & MAX_SOUND_LEVEL; else port[0x0d] = c; return;
+        case 0xe7cd: if(port[0x0f] & 4) {sound = c & MAX_SOUND_LEVEL; Updatesound();} else port[0x0d] = c; return;
         case 0xe7ce: port[0x0e] = c; return; //registre controle position joysticks
         case 0xe7cf: port[0x0f] = c; return; //registre controle action - musique
         case 0xe7d0: port[0x10] = c; return; //save the value written to know if an
@@ -951,7 +1482,7 @@ static char MgetTo(unsigned short a)
         case 0xe7cd: return((port[0x0f] & 4) ? joysaction | sound : port[0x0d]);
         case 0xe7ce: return 0x04;
         case 0xe7da: return x7da[port[0x1b]++ & 0x1f];
-        case 0xe7df: port[0x1e] = 0; return(port[0x1f]);
+        case 0xe7df: port[0x1e] = 0; Typedkeyread(); return(port[0x1f]);
         case 0xe7e4: return port[0x1d] & 0xf0;
         case 0xe7e5: return port[0x25] & 0x1f;
         case 0xe7e6: return port[0x26] & 0x7f;
@@ -980,13 +1511,13 @@ static void MputTo7(unsigned short a, char c)
       selectRomBank();
       return;
     case 0x2: case 0x3: if((port[0x26] & 0x60) != 0x60) return;
-      if(port[0x26] & 0x20) rombank[a - 0x2000] = c; else rombank[a] = c; return;
+      if(port[0x26] & 0x20) MEMWRITE(rombank + a - 0x2000, c) else MEMWRITE(rombank + a, c) return;
     // 4000->5fff: Memoire Ecran
-    case 0x4: case 0x5: ramvideo[a] = c; return;
+    case 0x4: case 0x5: RAMWRITE(ramvideo + a, c) return;
     // 6000->dfff: Memoire
-    case 0x6: case 0x7: case 0x8: case 0x9: ramuser[a] = c; return;
+    case 0x6: case 0x7: case 0x8: case 0x9: RAMWRITE(ramuser + a, c) return;
     case 0xa: case 0xb: case 0xc: case 0xd:
-      if (currentModel == TO7) ramuser[a] = c; else rambank[a] = c; return;
+      if (currentModel == TO7) RAMWRITE(ramuser + a, c) else RAMWRITE(rambank + a, c) return;
     case 0xe:
       switch(a)
       {
@@ -1001,7 +1532,7 @@ static void MputTo7(unsigned short a, char c)
         // e7c6: Timer MSB
         // e7c7: Timer LSB
         case 0xe7c0: port[0x00] = c; return;
-        case 0xe7c1: port[0x01] = c; mute = c & 8; return;
+        case 0xe7c1: port[0x01] = c; mute = c & 8; Updatesound(); return;
         case 0xe7c3: port[0x03] = (c & 0x7d);
         selectVideoRam(); selectRomBank(); return;
         case 0xe7c5: port[0x05] = c; Timercontrol(); return; //controle timer
@@ -1022,7 +1553,7 @@ static void MputTo7(unsigned short a, char c)
         //e7ce: registre de controle port A (CRA)
         //e7cf: registre de controle port B (CRB)
         case 0xe7cc: port[0x0c] = c; return;
-        case 0xe7cd: if(port[0x0f] & 4) sound = c & MAX_SOUND_LEVEL; else port[0x0d] = c; return;
+        case 0xe7cd: if(port[0x0f] & 4) {sound = c & MAX_SOUND_LEVEL; Updatesound();} else port[0x0d] = c; return;
         case 0xe7ce: port[0x0e] = c; return; //registre controle position joysticks
         case 0xe7cf: port[0x0f] = c; return; //registre controle action - musique
         // e7d0->e7df: Controlleur disque
@@ -1070,7 +1601,7 @@ static char readTo7KeybPortA()
   // Check if each key on the current line is pressed or not
   for (keyb_matrix_column = 0; keyb_matrix_column < 8; keyb_matrix_column++)
   {
-    if (touche[matrix_offset + keyb_matrix_column] == 0)
+    if (Readkey(matrix_offset + keyb_matrix_column) == 0)
     {
       porta_inv |= (1 << keyb_matrix_column);
     }
@@ -1157,24 +1688,24 @@ static void MputMo(unsigned short a, char c)
 #endif
   switch(a >> 12)
   {
-    case 0x0: case 0x1: ramvideo[a] = c; return;
-    case 0x2: case 0x3: case 0x4: case 0x5: ramuser[a] = c; return;
+    case 0x0: case 0x1: RAMWRITE(ramvideo + a, c) return;
+    case 0x2: case 0x3: case 0x4: case 0x5: RAMWRITE(ramuser + a, c) return;
     case 0x6: case 0x7: case 0x8: case 0x9:
-      if (rom->is_mo6) rambank[a] = c; else ramuser[a] = c; return;
+      if (rom->is_mo6) RAMWRITE(rambank + a, c) else RAMWRITE(ramuser + a, c) return;
     case 0xa:
       switch(a)
       {
         // A7C0->A7C3 : PIA 6821 Systeme
         case 0xa7c0: if (currentModel == MO5) { port[0] = c & 0x5f; selectVideoRam(); }
                      else { port[0] = c & 0x39; selectVideoRam(); selectRomBank(); } return;
-        case 0xa7c1: port[1] = c & 0x7f; sound = (c & 1) << 5; return;
+        case 0xa7c1: port[1] = c & 0x7f; sound = (c & 1) << 5; Updatesound(); return;
         case 0xa7c2: port[2] = c & 0x3f; return;
         case 0xa7c3: port[3] = c & 0x3f; return;
         // A7CB is used by the Jane cartridge and the 64k RAM extension
         case 0xa7cb: carflags = c; selectRomBank(); break;
         // A7CC->A7CF : Music and Game Extension
         case 0xa7cc: port[0x0c] = c; return;
-        case 0xa7cd: port[0x0d] = c; sound = c & MAX_SOUND_LEVEL; return;
+        case 0xa7cd: port[0x0d] = c; sound = c & MAX_SOUND_LEVEL; Updatesound(); return;
         case 0xa7ce: port[0x0e] = c; return; //registre controle position joysticks
         case 0xa7cf: port[0x0f] = c; return; //registre controle action - musique
         // A7DA->A7DB : Gate Palette Registers
@@ -1192,7 +1723,7 @@ static void MputMo(unsigned short a, char c)
       if ((carflags & 8) && (cartype == 0)) rombank[a] = c;
       return;
     case 0xf: return;
-    default: ramuser[a] = c;
+    default: RAMWRITE(ramuser + a, c)
  }
 }
 
@@ -1213,7 +1744,7 @@ static char mo6keybPB7()
     line &= 0x07;
   }
   scancode = (line << 3) | col;
-  return touche[scancode];
+  return Readkey(scancode);
 }
 
 // MO5/MO6 memory read ////////////////////////////////////////////////////////////
@@ -1233,7 +1764,7 @@ static char MgetMo(unsigned short a)
       {
         // A7C0->A7C3 : PIA 6821 Systeme
         case 0xa7c0: return (currentModel == MO5) ? port[0] | 0x80 | (penbutton << 5) : port[0] | 0x80 | (penbutton << 1);
-        case 0xa7c1: return (currentModel == MO5) ? port[1] | touche[(port[1] & 0xfe) >> 1]
+        case 0xa7c1: return (currentModel == MO5) ? port[1] | Readkey((port[1] & 0xfe) >> 1)
                      : port[1] | mo6keybPB7();
         case 0xa7c2: return port[2];
         case 0xa7c3: return port[3] | ~Initn();
@@ -1263,157 +1794,223 @@ static char MgetMo(unsigned short a)
  }
 }
 
+// Machines emulees //////////////////////////////////////////////////////////
+static char defaultram[RAM_SIZE];
+static char defaultcar[CARTRIDGE_MEM_SIZE];
+static ThomsonMachine defaultmachine;
+THREAD_LOCAL ThomsonMachine *machine = &defaultmachine;
+
+// Etat initial d'une machine (TO8)
+static void InitMachine(ThomsonMachine *m, char *mram, char *mcar)
+{
+  ThomsonMachine *current = machine;
+  memset(m, 0, sizeof(ThomsonMachine));
+  machine = m;
+  ram = mram;
+  car = mcar;
+  currentModel = TO8;
+  rom = &ROM_TO8;
+  ramclock = 1;
+  videoenabled = true;
+  audioenabled = true;
+  SetVideoPixelFormat(VIDEO_PIXEL_RGB565);
+  SetFloppyWriteProtect(true);
+  SetTapeWriteProtect(true);
+  SetModeTO(true);
+  machine = current;
+}
+
+void InitMachines(void)
+{
+  PatchRoms();
+#ifdef COW_MEMORY
+  CreateRamFile();
+#endif
+  InitMachine(&defaultmachine, defaultram, defaultcar);
+}
+
+static void FreeMemory(char *mem, size_t size, bool mapped)
+{
+#ifdef COW_MEMORY
+  if (mapped)
+  {
+    if (mem != NULL) munmap(mem, size);
+    return;
+  }
+#else
+  (void) size, (void) mapped;
+#endif
+  free(mem);
+}
+
+ThomsonMachine *CreateMachine(void)
+{
+  ThomsonMachine *current = machine;
+  ThomsonMachine *m = malloc(sizeof(ThomsonMachine));
+  char *mram = NULL;
+  char *mcar = NULL;
+  bool mapped = false;
+#ifdef COW_MEMORY
+  if (ramfd >= 0)
+  {
+    mram = MapMemory(ramfd, RAM_SIZE);
+    mcar = MapMemory(-1, CARTRIDGE_MEM_SIZE);
+    mapped = (mram != NULL) && (mcar != NULL);
+    if (!mapped)
+    {
+      if (mram != NULL) munmap(mram, RAM_SIZE);
+      if (mcar != NULL) munmap(mcar, CARTRIDGE_MEM_SIZE);
+      mram = mcar = NULL;
+    }
+  }
+#endif
+  if (!mapped)
+  {
+    mram = malloc(RAM_SIZE);
+    mcar = malloc(CARTRIDGE_MEM_SIZE);
+  }
+  if ((m == NULL) || (mram == NULL) || (mcar == NULL))
+  {
+    free(m);
+    FreeMemory(mram, RAM_SIZE, mapped);
+    FreeMemory(mcar, CARTRIDGE_MEM_SIZE, mapped);
+    return NULL;
+  }
+  InitMachine(m, mram, mcar);
+  m->mappedmemory = mapped;
+  // meme frequence d'echantillonnage que la machine par defaut
+  m->audio.cpufrequency = defaultmachine.audio.cpufrequency;
+  m->audio.samplespercycle = defaultmachine.audio.samplespercycle;
+  machine = m;
+  Hardreset();
+  machine = current;
+  return m;
+}
+
+void DestroyMachine(ThomsonMachine *m)
+{
+  ThomsonMachine *current = machine;
+  if ((m == NULL) || (m == &defaultmachine)) return;
+  machine = m;
+  CloseDevices();
+  FreeMemory(ram, RAM_SIZE, machine->mappedmemory);
+  FreeMemory(car, CARTRIDGE_MEM_SIZE, machine->mappedmemory);
+  machine = (current != m) ? current : &defaultmachine;
+  free(m);
+}
+
+void SetCurrentMachine(ThomsonMachine *m)
+{
+  machine = (m != NULL) ? m : &defaultmachine;
+}
+
+ThomsonMachine *GetCurrentMachine(void)
+{
+  return machine;
+}
+
+char *GetRam(void)
+{
+  return ram;
+}
+
+// Taille de la RAM adressable par le modele //////////////////////////////////
+unsigned int GetModelRamSize(ThomsonModel model)
+{
+  switch (model)
+  {
+    // 16K video + 32K utilisateur (MO5), 16K video + 8K + 16K d'extension (TO7)
+    case MO5: case TO7: return 0xc000;
+    // 16K video + 16K utilisateur + 6 banques de 16K
+    case TO9: case TO7_70: return 0x20000;
+    // 32 pages de 16K
+    default: return RAM_SIZE;
+  }
+}
+
+unsigned int GetRamSize(void)
+{
+  return GetModelRamSize(currentModel);
+}
+
+// Taille de l'etat hors RAM
+static unsigned int HotStateSize(void)
+{
+  return sizeof(StateHeader) + sizeof(MachineState) + cpu_serialize_size()
+      + video_serialize_size() + device_serialize_size();
+}
+
 unsigned int toemulator_serialize_size(void)
 {
-  return sizeof(currentModel) + cpu_serialize_size() + video_serialize_size()
-      + sizeof(ram) + sizeof(port) + sizeof(x7da) + device_serialize_size()
-      + sizeof(reserved1) + sizeof(reserved2) + sizeof(reserved3) + sizeof(reserved4)
-      + sizeof(carflags) + sizeof(touche) + sizeof(capslock) + sizeof(joysposition)
-      + sizeof(joysaction) + sizeof(xpen) + sizeof(ypen) + sizeof(penbutton)
-      + sizeof(videolinecycle) + sizeof(videolinenumber) + sizeof(vblnumber)
-      + sizeof(displayflag) + sizeof(bordercolor) + sizeof(sound) + sizeof(mute)
-      + sizeof(timer6846) + sizeof(latch6846) + sizeof(keyb_irqcount) + sizeof(timer_irqcount);
+  return HotStateSize() + GetRamSize();
 }
 
-void toemulator_serialize(void *data)
+// Sauvegarde de l'etat (avec ou sans la RAM) ////////////////////////////////
+static void Serialize(char *buffer, bool withram)
 {
-  int offset = 0;
-  char *buffer = (char *) data;
-
-  memcpy(buffer+offset, &currentModel, sizeof(currentModel));
-  offset += sizeof(currentModel);
-
-  cpu_serialize(buffer+offset);
-  offset += cpu_serialize_size();
-  video_serialize(buffer+offset);
-  offset += video_serialize_size();
-
-  memcpy(buffer+offset, ram, sizeof(ram));
-  offset += sizeof(ram);
-  memcpy(buffer+offset, port, sizeof(port));
-  offset += sizeof(port);
-  memcpy(buffer+offset, x7da, sizeof(x7da));
-  offset += sizeof(x7da);
-
-  device_serialize(buffer+offset);
-  offset += device_serialize_size();
-
-  memcpy(buffer+offset, &reserved1, sizeof(reserved1));
-  offset += sizeof(reserved1);
-  memcpy(buffer+offset, &reserved2, sizeof(reserved2));
-  offset += sizeof(reserved2);
-  memcpy(buffer+offset, &reserved3, sizeof(reserved3));
-  offset += sizeof(reserved3);
-  memcpy(buffer+offset, &reserved4, sizeof(reserved4));
-  offset += sizeof(reserved4);
-  memcpy(buffer+offset, &carflags, sizeof(carflags));
-  offset += sizeof(carflags);
-  memcpy(buffer+offset, touche, sizeof(touche));
-  offset += sizeof(touche);
-  memcpy(buffer+offset, &capslock, sizeof(capslock));
-  offset += sizeof(capslock);
-  memcpy(buffer+offset, &joysposition, sizeof(joysposition));
-  offset += sizeof(joysposition);
-  memcpy(buffer+offset, &joysaction, sizeof(joysaction));
-  offset += sizeof(joysaction);
-  memcpy(buffer+offset, &xpen, sizeof(xpen));
-  offset += sizeof(xpen);
-  memcpy(buffer+offset, &ypen, sizeof(ypen));
-  offset += sizeof(ypen);
-  memcpy(buffer+offset, &penbutton, sizeof(penbutton));
-  offset += sizeof(penbutton);
-  memcpy(buffer+offset, &videolinecycle, sizeof(videolinecycle));
-  offset += sizeof(videolinecycle);
-  memcpy(buffer+offset, &videolinenumber, sizeof(videolinenumber));
-  offset += sizeof(videolinenumber);
-  memcpy(buffer+offset, &vblnumber, sizeof(vblnumber));
-  offset += sizeof(vblnumber);
-  memcpy(buffer+offset, &displayflag, sizeof(displayflag));
-  offset += sizeof(displayflag);
-  memcpy(buffer+offset, &bordercolor, sizeof(bordercolor));
-  offset += sizeof(bordercolor);
-  memcpy(buffer+offset, &sound, sizeof(sound));
-  offset += sizeof(sound);
-  memcpy(buffer+offset, &mute, sizeof(mute));
-  offset += sizeof(mute);
-  memcpy(buffer+offset, &timer6846, sizeof(timer6846));
-  offset += sizeof(timer6846);
-  memcpy(buffer+offset, &latch6846, sizeof(latch6846));
-  offset += sizeof(latch6846);
-  memcpy(buffer+offset, &keyb_irqcount, sizeof(keyb_irqcount));
-  offset += sizeof(keyb_irqcount);
-  memcpy(buffer+offset, &timer_irqcount, sizeof(timer_irqcount));
-}
-
-void toemulator_unserialize(const void *data)
-{
-  int offset = 0;
-  const char *buffer = (const char *) data;
-  ThomsonModel model;
+  StateHeader header;
+  char *p = buffer;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = STATE_MAGIC;
+  header.version = STATE_VERSION;
+  header.model = currentModel;
+  header.ramsize = GetRamSize();
+  memcpy(p, &header, sizeof(header));
+  p += sizeof(header);
+
+  // Les evenements d'entree sont a la fin de l'etat : ceux qui ne sont pas
+  // en attente sont mis a zero
+  memcpy(p, &machine->state, sizeof(MachineState));
+  memset(p + sizeof(MachineState) - (INPUT_QUEUE_SIZE - ninputevents) * sizeof(InputEvent), 0,
+         (INPUT_QUEUE_SIZE - ninputevents) * sizeof(InputEvent));
+  p += sizeof(MachineState);
+
+  cpu_serialize(p);
+  p += cpu_serialize_size();
+  if (!videoenabled)
+  {
+    // Rendering pointers are not updated when the video is disabled
+    ResyncVideoBeam();
+  }
+  video_serialize(p);
+  p += video_serialize_size();
+  device_serialize(p);
+  p += device_serialize_size();
 
-  memcpy(&model, buffer+offset, sizeof(model));
-  offset += sizeof(model);
-  SetThomsonModel(model);
-
-  cpu_unserialize(buffer+offset);
-  offset += cpu_serialize_size();
-  video_unserialize(buffer+offset);
-  offset += video_serialize_size();
-  memcpy(ram, buffer+offset, sizeof(ram));
-  offset += sizeof(ram);
-  memcpy(port, buffer+offset, sizeof(port));
-  offset += sizeof(port);
-  memcpy(x7da, buffer+offset, sizeof(x7da));
-  offset += sizeof(x7da);
-
-  device_unserialize(buffer+offset);
-  offset += device_serialize_size();
-
-  memcpy(&reserved1, buffer+offset, sizeof(reserved1));
-  offset += sizeof(reserved1);
-  memcpy(&reserved2, buffer+offset, sizeof(reserved2));
-  offset += sizeof(reserved2);
-  memcpy(&reserved3, buffer+offset, sizeof(reserved3));
-  offset += sizeof(reserved3);
-  memcpy(&reserved4, buffer+offset, sizeof(reserved4));
-  offset += sizeof(reserved4);
-  memcpy(&carflags, buffer+offset, sizeof(carflags));
-  offset += sizeof(carflags);
-  memcpy(touche, buffer+offset, sizeof(touche));
-  offset += sizeof(touche);
-  memcpy(&capslock, buffer+offset, sizeof(capslock));
-  offset += sizeof(capslock);
-  memcpy(&joysposition, buffer+offset, sizeof(joysposition));
-  offset += sizeof(joysposition);
-  memcpy(&joysaction, buffer+offset, sizeof(joysaction));
-  offset += sizeof(joysaction);
-  memcpy(&xpen, buffer+offset, sizeof(xpen));
-  offset += sizeof(xpen);
-  memcpy(&ypen, buffer+offset, sizeof(ypen));
-  offset += sizeof(ypen);
-  memcpy(&penbutton, buffer+offset, sizeof(penbutton));
-  offset += sizeof(penbutton);
-  memcpy(&videolinecycle, buffer+offset, sizeof(videolinecycle));
-  offset += sizeof(videolinecycle);
-  memcpy(&videolinenumber, buffer+offset, sizeof(videolinenumber));
-  offset += sizeof(videolinenumber);
-  memcpy(&vblnumber, buffer+offset, sizeof(vblnumber));
-  offset += sizeof(vblnumber);
-  memcpy(&displayflag, buffer+offset, sizeof(displayflag));
-  offset += sizeof(displayflag);
-  memcpy(&bordercolor, buffer+offset, sizeof(bordercolor));
-  offset += sizeof(bordercolor);
-  memcpy(&sound, buffer+offset, sizeof(sound));
-  offset += sizeof(sound);
-  memcpy(&mute, buffer+offset, sizeof(mute));
-  offset += sizeof(mute);
-  memcpy(&timer6846, buffer+offset, sizeof(timer6846));
-  offset += sizeof(timer6846);
-  memcpy(&latch6846, buffer+offset, sizeof(latch6846));
-  offset += sizeof(latch6846);
-  memcpy(&keyb_irqcount, buffer+offset, sizeof(keyb_irqcount));
-  offset += sizeof(keyb_irqcount);
-  memcpy(&timer_irqcount, buffer+offset, sizeof(timer_irqcount));
+  if (withram)
+  {
+    memcpy(p, ram, header.ramsize);
+  }
+}
+
+// Restauration de l'etat (avec ou sans la RAM) //////////////////////////////
+static void Unserialize(const char *buffer, bool withram)
+{
+  StateHeader header;
+  const char *p = buffer;
+
+  memcpy(&header, p, sizeof(header));
+  p += sizeof(header);
+  SetThomsonModel((ThomsonModel) header.model);
+
+  memcpy(&machine->state, p, sizeof(MachineState));
+  p += sizeof(MachineState);
+  Updatedisplayflag();
+  Updatesound();
+
+  cpu_unserialize(p);
+  p += cpu_serialize_size();
+  video_unserialize(p);
+  p += video_serialize_size();
+  device_unserialize(p);
+  p += device_serialize_size();
+
+  if (withram)
+  {
+    memcpy(ram, p, header.ramsize);
+    MarkRamModified();
+  }
 
   if (currentModel != MO5)
   {
@@ -1423,3 +2020,182 @@ void toemulator_unserialize(const void *data)
   selectVideoRam();
   selectRomBank();
 }
+
+void toemulator_serialize(void *data)
+{
+  Serialize((char *) data, true);
+}
+
+unsigned int toemulator_hotstate_size(void)
+{
+  return HotStateSize();
+}
+
+void toemulator_serialize_hotstate(void *data)
+{
+  Serialize((char *) data, false);
+}
+
+void toemulator_unserialize_hotstate(const void *data)
+{
+  Unserialize((const char *) data, false);
+}
+
+// Verification des index d'un etat charge (le MachineState est verifie par IsMachineStateValid)
+static bool IsStateValid(const char *buffer)
+{
+  MachineState s;
+  memcpy(&s, buffer + sizeof(StateHeader), sizeof(MachineState));
+  return IsMachineStateValid(&s)
+      && video_state_valid(buffer + sizeof(StateHeader) + sizeof(MachineState) + cpu_serialize_size());
+}
+
+bool toemulator_unserialize(const void *data, unsigned int size)
+{
+  StateHeader header;
+  if (size < sizeof(header))
+  {
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if ((header.magic != STATE_MAGIC) || (header.version != STATE_VERSION)
+      || (header.model < TO8) || (header.model > TO7_70)
+      || (header.ramsize != GetModelRamSize((ThomsonModel) header.model))
+      || (size != HotStateSize() + header.ramsize)
+      || !IsStateValid((const char *) data))
+  {
+    return false;
+  }
+  Unserialize((const char *) data, true);
+  return true;
+}
+
+// Etats modeles ///////////////////////////////////////////////////////////////
+// Une machine remise dans l'etat d'un modele ne copie que les pages de RAM
+// modifiees depuis sa remise precedente dans le meme etat.
+struct MachineTemplate
+{
+  unsigned int id;                  //identifiant unique de l'etat
+  ThomsonModel model;
+  int64_t date;                     //date ecrite en ROM
+  char *state;                      //etat de l'emulateur hors RAM
+  char *memory;                     //RAM du modele
+  unsigned int ramsize;
+  char cartridge[CARTRIDGE_MEM_SIZE];
+  char datebank[ROM_DATE_BANK_SIZE];
+  char keybank[ROM_KEY_BANK_SIZE];
+};
+
+static unsigned int templateids = 0;
+
+MachineTemplate *CreateMachineTemplate(void)
+{
+  MachineTemplate *t = malloc(sizeof(MachineTemplate));
+  if (t == NULL) return NULL;
+  t->ramsize = GetRamSize();
+  t->state = malloc(HotStateSize());
+  t->memory = malloc(t->ramsize);
+  if ((t->state == NULL) || (t->memory == NULL))
+  {
+    DestroyMachineTemplate(t);
+    return NULL;
+  }
+#ifdef __GNUC__
+  t->id = __sync_add_and_fetch(&templateids, 1);
+#else
+  t->id = ++templateids;
+#endif
+  t->model = currentModel;
+  t->date = emulateddate;
+  Serialize(t->state, false);
+  memcpy(t->memory, ram, t->ramsize);
+  memcpy(t->cartridge, car, CARTRIDGE_MEM_SIZE);
+  memcpy(t->datebank, machine->datebank, ROM_DATE_BANK_SIZE);
+  memcpy(t->keybank, machine->keybank, ROM_KEY_BANK_SIZE);
+  return t;
+}
+
+void DestroyMachineTemplate(MachineTemplate *t)
+{
+  if (t == NULL) return;
+  free(t->state);
+  free(t->memory);
+  free(t);
+}
+
+void ResetToTemplate(const MachineTemplate *t)
+{
+  bool partial = (machine->templateid == t->id) && (currentModel == t->model);
+  unsigned int checkpoint = machine->templatecheckpoint;
+  int npages = t->ramsize >> RAM_PAGE_SHIFT;
+  int i;
+  Unserialize(t->state, false);
+  for (i = 0; i < npages; i++)
+  {
+    if (!partial || IsRamPageModified(i, checkpoint))
+    {
+      memcpy(ram + (i << RAM_PAGE_SHIFT), t->memory + (i << RAM_PAGE_SHIFT), 1 << RAM_PAGE_SHIFT);
+      rampageclock[i] = ramclock;
+    }
+  }
+  // l'espace cartouche n'est ecrit que s'il differe (il peut etre partage)
+  if (memcmp(car, t->cartridge, CARTRIDGE_MEM_SIZE) != 0)
+  {
+    memcpy(car, t->cartridge, CARTRIDGE_MEM_SIZE);
+  }
+  memcpy(machine->datebank, t->datebank, ROM_DATE_BANK_SIZE);
+  memcpy(machine->keybank, t->keybank, ROM_KEY_BANK_SIZE);
+  emulateddate = t->date;
+  machine->templateid = t->id;
+  machine->templatecheckpoint = RamCheckpoint();
+}
+
+// Run-ahead //////////////////////////////////////////////////////////////////
+// La RAM n'est pas sauvegardee en entier : seules les pages modifiees depuis
+// la sauvegarde precedente sont copiees, et seules les pages modifiees depuis
+// la sauvegarde sont restaurees.
+static char runaheadram[RAM_SIZE];      //copie de la RAM
+static char *runaheadstate = NULL;      //etat de l'emulateur hors RAM
+static bool runaheadramvalid = false;   //la copie de la RAM est complete
+static unsigned int runaheadcheckpoint; //point de controle de la sauvegarde
+
+bool SaveRunAheadState(void)
+{
+  unsigned int checkpoint = RamCheckpoint();
+  int npages = GetRamSize() >> RAM_PAGE_SHIFT;
+  int i;
+  if (runaheadstate == NULL)
+  {
+    runaheadstate = malloc(HotStateSize());
+    if (runaheadstate == NULL)
+    {
+      return false;
+    }
+  }
+  for (i = 0; i < npages; i++)
+  {
+    if (!runaheadramvalid || IsRamPageModified(i, runaheadcheckpoint))
+    {
+      memcpy(runaheadram + (i << RAM_PAGE_SHIFT), ram + (i << RAM_PAGE_SHIFT), 1 << RAM_PAGE_SHIFT);
+    }
+  }
+  runaheadramvalid = true;
+  runaheadcheckpoint = checkpoint;
+  Serialize(runaheadstate, false);
+  return true;
+}
+
+void RestoreRunAheadState(void)
+{
+  int npages = GetRamSize() >> RAM_PAGE_SHIFT;
+  int i;
+  for (i = 0; i < npages; i++)
+  {
+    if (IsRamPageModified(i, runaheadcheckpoint))
+    {
+      memcpy(ram + (i << RAM_PAGE_SHIFT), runaheadram + (i << RAM_PAGE_SHIFT), 1 << RAM_PAGE_SHIFT);
+      rampageclock[i] = ramclock;
+    }
+  }
+  Unserialize(runaheadstate, false);
+}
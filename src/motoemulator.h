@@ -27,69 +27,144 @@
 
 // Size of RAM (512K)
 #define RAM_SIZE 0x80000
+// RAM modifications are tracked by pages of 256 bytes
+#define RAM_PAGE_SHIFT 8
+#define RAM_PAGE_NUMBER (RAM_SIZE >> RAM_PAGE_SHIFT)
+// Number of CPU cycles of a video frame (312 lines of 64 cycles)
+#define FRAME_CYCLES (312 * 64)
 // Size of cartridge memory space (4x16K)
 #define CARTRIDGE_MEM_SIZE 0x10000
 // Size of I/O ports space
 #define IO_MEM_SIZE 0x40
 
-// memory
-//espace cartouche 4x16K
-extern char car[];
-//ram 512K
-extern char ram[];
-//ports d'entree/sortie (0xE7C0 -> 0xE7FF)
-extern char port[];
-
-//flags cartouche
-//type de cartouche (0=simple 1=switch bank, 2=os-9)
-extern int cartype;
-//bits0,1,4=bank, 2=cart-enabled, 3=write-enabled
-extern int carflags;
-
-//lightpen coordinates
-extern int xpen, ypen;
-//lightpen button state
-extern int penbutton;
-
-//affichage
-//compteur ligne (0-63)
-extern int videolinecycle;
-//numero de ligne video affichee (0-311)
-extern int videolinenumber;
-//couleur de la bordure de l'écran
-extern int bordercolor;
-//pointeur page video affichee
-extern char *pagevideo;
-
 typedef enum { JOY0_UP, JOY0_DOWN, JOY0_LEFT, JOY0_RIGHT,
                JOY1_UP, JOY1_DOWN, JOY1_LEFT, JOY1_RIGHT,
                JOY0_FIRE, JOY1_FIRE } JoystickAxis;
 
 typedef enum { TO8, TO8D, TO9, TO9P, MO5, MO6, PC128, TO7, TO7_70 } ThomsonModel;
 
+typedef enum { INPUT_KEYBOARD, INPUT_JOYSTICK, INPUT_LIGHTPEN } InputEventType;
+// Filter of the input events, called with the parameters of the Queue* functions
+// (scancode/down, axis/isOn or x/y/button): the event is ignored if it returns false
+typedef bool (*InputFilter)(InputEventType type, int cycle, int a, int b, int c);
+
+// Emulated machine. The functions of the emulator work on the current machine
+// of the calling thread, which is the default machine unless another machine
+// is selected. The ROM images are shared by all the machines.
+typedef struct ThomsonMachine ThomsonMachine;
+// Initialisation of the default machine and of the ROM images
+// (must be called once, before any other function)
+void InitMachines(void);
+// Creates a new machine (TO8 after a hardreset), with the audio settings of the
+// default machine. Once selected, its video buffer must be set before emulating
+// frames (unless the rendering is disabled).
+// Returns NULL if there is not enough memory.
+ThomsonMachine *CreateMachine(void);
+// Destroys a machine created by CreateMachine (its media are unloaded)
+void DestroyMachine(ThomsonMachine *m);
+// Selects the machine emulated by the calling thread (NULL = default machine)
+void SetCurrentMachine(ThomsonMachine *m);
+// Returns the machine emulated by the calling thread
+ThomsonMachine *GetCurrentMachine(void);
+
+// Returns the RAM of the current machine
+char *GetRam(void);
+// Returns the size of the RAM that the current model can address
+// (the beginning of ram[], the remaining part is not used)
+unsigned int GetRamSize(void);
+// Returns the size of the RAM that the given model can address
+unsigned int GetModelRamSize(ThomsonModel model);
+// Returns a checkpoint for the tracking of RAM modifications
+unsigned int RamCheckpoint(void);
+// Returns true if the RAM page has been written since the checkpoint
+bool IsRamPageModified(int page, unsigned int checkpoint);
+// Marks a RAM page as modified (when it is written outside of the emulation)
+void MarkRamPageModified(int page);
+// Marks the whole RAM as modified
+void MarkRamModified(void);
 // Returns the current level of the speaker as a signed 16-bit integer
 int16_t GetAudioSample(void);
 // Joystick emulation
 void Joysemul(JoystickAxis axis, bool isOn);
 // Keyboard emulation
 void keyboard(int scancode, bool down);
+// Input events applied during the next frame, at the given cycle from its beginning.
+// Two keyboard events are at least one frame apart, so that the emulated
+// computer sees each of them.
+void QueueKeyboard(int cycle, int scancode, bool down);
+void QueueJoystick(int cycle, JoystickAxis axis, bool isOn);
+void QueueLightpen(int cycle, int x, int y, int button);
+// Size of the queue of the typed keys (the keys typed when it is full are ignored)
+#define TYPED_KEYS_SIZE 128
+// Types a key on the keyboard (down or up): the typed keys are applied one after
+// the other, as soon as the emulated computer has read the previous one.
+void TypeKeyboard(int scancode, bool down);
+// Returns true if typed keys have not been applied yet
+bool IsTyping(void);
+// Returns true if the computer was waiting for a key in its menu or BASIC
+// after the boot (most of the previous frame spent in the keyboard wait loop)
+bool IsWaitingForKey(void);
+// Sets the filter of the input events (NULL = no filter)
+void SetInputFilter(InputFilter filter);
 // Initialisation of the computer
 void Initprog(void);
 // Execution of n CPU cycles
 int Run(int ncyclesmax);
+// Execution until the end of the current video frame (after line 311)
+void RunFrame(void);
+// Returns the number of CPU cycles executed since the previous call
+// (the audio level changes are timestamped from the previous call)
+int ElapsedCycles(void);
 // Hardreset of the computer
 void Hardreset(void);
+// Sets the date written in the ROM of the TO8/TO8D/TO9+ at the next hardreset,
+// in seconds since the epoch (0 = current date)
+void SetEmulatedDate(int64_t date);
+// Enables or disables the rendering of the screen (default=enabled).
+// The emulation itself is not affected.
+void SetVideoEnabled(bool enabled);
+// Enables or disables the output of the sound to the audio module (default=enabled).
+// The emulation itself is not affected.
+void SetAudioEnabled(bool enabled);
 // Sets the Thomson model emulated (default=TO8)
 void SetThomsonModel(ThomsonModel model);
 // Gets the currently emulated Thomson model
 ThomsonModel GetThomsonModel(void);
+// Returns a checksum of the patches applied to the ROM of the current model
+// (a state saved with other patches may not be valid)
+uint64_t GetRomChecksum(void);
 
 // The following functions are used for libretro's save states feature.
-// Returns the amount of data required to serialize the whole state of the emulator.
+// The state begins with a versioned header, followed by the state of the
+// emulator in fixed size blocks, and ends with the RAM of the current model.
+// Returns the amount of data required to serialize the whole state of the emulator
+// (it depends on the current model).
 unsigned int toemulator_serialize_size(void);
 // Serializes the whole state of the emulator.
 void toemulator_serialize(void *data);
 // Unserializes the whole state of the emulator.
-void toemulator_unserialize(const void *data);
+// Returns false if the data is not a valid state of this version.
+bool toemulator_unserialize(const void *data, unsigned int size);
+// Same functions for the state without the RAM (for the current model only),
+// the RAM being saved separately.
+unsigned int toemulator_hotstate_size(void);
+void toemulator_serialize_hotstate(void *data);
+void toemulator_unserialize_hotstate(const void *data);
+
+// Template states: states of a machine (usually just booted) that other machines
+// can be reset to quickly. Only the RAM pages modified since the previous reset of
+// the machine to the same template are copied.
+typedef struct MachineTemplate MachineTemplate;
+// Captures the state of the current machine (NULL if there is not enough memory)
+MachineTemplate *CreateMachineTemplate(void);
+void DestroyMachineTemplate(MachineTemplate *t);
+// Resets the current machine to a template (the media are not changed)
+void ResetToTemplate(const MachineTemplate *t);
+
+// Run-ahead: saves the state of the emulator before emulating frames ahead,
+// then restores it. Only the RAM pages modified in between are copied.
+// SaveRunAheadState() returns false if the state cannot be allocated.
+bool SaveRunAheadState(void);
+void RestoreRunAheadState(void);
 
 #endif /* __TOEMULATION_H */
@@ -0,0 +1,441 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Input movies: recording and replay of the input events.
+ * A movie file begins with a header (magic, version, model, date written in
+ * the ROM), followed by one item per frame, or per run of frames with the same
+ * events (the joysticks and the light pen are queued at each frame):
+ * - MOVIE_FRAME, number of events (varint), then for each event: type (1 byte),
+ *   cycle and parameters of the Queue* call (signed varints);
+ * - MOVIE_REPEAT, number of frames (varint) with the same events as the previous frame;
+ * - MOVIE_END at the end of the movie.
+ * A movie can be replayed by the libretro interface (the input of the frontend
+ * is then ignored) or by a MovieReader, which queues the events of each frame
+ * in the current machine of the calling thread (e.g. in the batch runner). */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <streams/file_stream.h>
+#include "movie.h"
+#include "motoemulator.h"
+#include "logger.h"
+
+#define MOVIE_MAGIC "TMOV"
+#define MOVIE_VERSION 1
+#define MOVIE_HEADER_SIZE 14
+#define MOVIE_REPEAT 0x00
+#define MOVIE_FRAME  0x01
+#define MOVIE_END    0xff
+// Max size of an encoded event
+#define MOVIE_EVENT_MAX_SIZE (1 + 4 * 5)
+
+typedef enum { MOVIE_NONE, MOVIE_RECORDING, MOVIE_PLAYING } MovieMode;
+
+// Events of a frame (encoded)
+typedef struct
+{
+  uint8_t *data;
+  unsigned int size;
+  unsigned int capacity;
+  unsigned int count;
+} FrameEvents;
+
+struct MovieReader
+{
+  uint8_t *data;
+  const uint8_t *end;
+  const uint8_t *pos;        // Next item to replay
+  const uint8_t *lastevents; // Events of the previous frame
+  unsigned int lastcount;
+  unsigned int repeatleft;   // Nb of frames left with the events of the previous frame
+  unsigned int length;       // Nb of frames of the movie
+};
+
+static MovieMode mode = MOVIE_NONE;
+static unsigned int frame;        // Current frame of the movie
+// Recording
+static RFILE *moviefile = NULL;
+static FrameEvents currentframe = { NULL, 0, 0, 0 };
+static FrameEvents previousframe = { NULL, 0, 0, 0 };
+static unsigned int repeat;       // Nb of frames with the same events as previousframe
+// Replay
+static MovieReader *player = NULL;
+static bool replaying = false;    // Events queued by the replay
+
+static uint8_t *PutVarint(uint8_t *p, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    *p++ = (value & 0x7f) | 0x80;
+    value >>= 7;
+  }
+  *p++ = value;
+  return p;
+}
+
+// Signed values are stored as 0, -1, 1, -2...
+static uint8_t *PutSignedVarint(uint8_t *p, int value)
+{
+  return PutVarint(p, ((uint32_t) value << 1) ^ (uint32_t) (value >> 31));
+}
+
+static const uint8_t *GetVarint(const uint8_t *p, const uint8_t *end, uint32_t *value)
+{
+  int shift = 0;
+  *value = 0;
+  while ((p < end) && (*p & 0x80) && (shift < 28))
+  {
+    *value |= (uint32_t) (*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  if (p < end)
+  {
+    *value |= (uint32_t) *p++ << shift;
+  }
+  return p;
+}
+
+static const uint8_t *GetSignedVarint(const uint8_t *p, const uint8_t *end, int *value)
+{
+  uint32_t v;
+  p = GetVarint(p, end, &v);
+  *value = (int) (v >> 1) ^ -(int) (v & 1);
+  return p;
+}
+
+static void WriteVarintItem(uint8_t type, uint32_t value)
+{
+  uint8_t item[1 + 5];
+  uint8_t *p = item;
+  *p++ = type;
+  p = PutVarint(p, value);
+  filestream_write(moviefile, item, p - item);
+}
+
+static void FlushRepeat(void)
+{
+  if (repeat > 0)
+  {
+    WriteVarintItem(MOVIE_REPEAT, repeat);
+    repeat = 0;
+  }
+}
+
+// Recording: the events of the frame are encoded in currentframe
+static bool RecordFilter(InputEventType type, int cycle, int a, int b, int c)
+{
+  uint8_t *p;
+  if (currentframe.size + MOVIE_EVENT_MAX_SIZE > currentframe.capacity)
+  {
+    unsigned int capacity = currentframe.capacity * 2 + 256;
+    uint8_t *data = realloc(currentframe.data, capacity);
+    if (data == NULL)
+    {
+      return true;
+    }
+    currentframe.data = data;
+    currentframe.capacity = capacity;
+  }
+  p = currentframe.data + currentframe.size;
+  *p++ = type;
+  p = PutSignedVarint(p, cycle);
+  p = PutSignedVarint(p, a);
+  p = PutSignedVarint(p, b);
+  p = PutSignedVarint(p, c);
+  currentframe.size = p - currentframe.data;
+  currentframe.count++;
+  return true;
+}
+
+// Replay: only the events of the movie are accepted
+static bool PlaybackFilter(InputEventType type, int cycle, int a, int b, int c)
+{
+  (void) type, (void) cycle, (void) a, (void) b, (void) c; // Unused parameters
+  return replaying;
+}
+
+// Queues count events (if queue is true) and returns the position after them
+static const uint8_t *ReplayEvents(const uint8_t *p, const uint8_t *end, unsigned int count, bool queue)
+{
+  while ((count-- > 0) && (p < end))
+  {
+    int type, cycle, a, b, c;
+    type = *p++;
+    p = GetSignedVarint(p, end, &cycle);
+    p = GetSignedVarint(p, end, &a);
+    p = GetSignedVarint(p, end, &b);
+    p = GetSignedVarint(p, end, &c);
+    if (!queue) continue;
+    switch (type)
+    {
+      case INPUT_KEYBOARD: if (c) TypeKeyboard(a, b); else QueueKeyboard(cycle, a, b); break;
+      case INPUT_JOYSTICK: QueueJoystick(cycle, a, b); break;
+      case INPUT_LIGHTPEN: QueueLightpen(cycle, a, b, c); break;
+    }
+  }
+  return p;
+}
+
+// Counts the frames of a movie. Returns false if an item is not valid.
+// A movie without MOVIE_END (recording interrupted) ends after its last complete item.
+static bool CountFrames(MovieReader *movie)
+{
+  const uint8_t *p = movie->data + MOVIE_HEADER_SIZE;
+  uint32_t value;
+  movie->length = 0;
+  while ((p < movie->end) && (*p != MOVIE_END))
+  {
+    if ((*p != MOVIE_FRAME) && (*p != MOVIE_REPEAT))
+    {
+      return false;
+    }
+    if (*p++ == MOVIE_FRAME)
+    {
+      p = GetVarint(p, movie->end, &value);
+      p = ReplayEvents(p, movie->end, value, false);
+      movie->length++;
+    }
+    else
+    {
+      p = GetVarint(p, movie->end, &value);
+      movie->length += value;
+    }
+  }
+  return true;
+}
+
+MovieReader *OpenMovie(const char *filename)
+{
+  MovieReader *movie = calloc(1, sizeof(MovieReader));
+  int64_t size;
+  if (movie == NULL)
+  {
+    return NULL;
+  }
+  if (!filestream_read_file(filename, (void **) &movie->data, &size) || (movie->data == NULL))
+  {
+    LOG_ERROR("Cannot read movie file %s.\n", filename);
+    free(movie);
+    return NULL;
+  }
+  movie->end = movie->data + size;
+  if ((size < MOVIE_HEADER_SIZE) || (memcmp(movie->data, MOVIE_MAGIC, 4) != 0)
+      || (movie->data[4] != MOVIE_VERSION) || (movie->data[5] > TO7_70) || !CountFrames(movie))
+  {
+    LOG_ERROR("Invalid movie file %s.\n", filename);
+    CloseMovie(movie);
+    return NULL;
+  }
+  movie->pos = movie->data + MOVIE_HEADER_SIZE;
+  movie->lastevents = movie->pos;
+  return movie;
+}
+
+void CloseMovie(MovieReader *movie)
+{
+  if (movie != NULL)
+  {
+    free(movie->data);
+    free(movie);
+  }
+}
+
+ThomsonModel GetMovieModel(const MovieReader *movie)
+{
+  return (ThomsonModel) movie->data[5];
+}
+
+int64_t GetMovieDate(const MovieReader *movie)
+{
+  int64_t date = 0;
+  int i;
+  for (i = 0; i < 8; i++)
+  {
+    date |= (int64_t) movie->data[6 + i] << (8 * i);
+  }
+  return date;
+}
+
+unsigned int GetMovieLength(const MovieReader *movie)
+{
+  return movie->length;
+}
+
+bool ReplayMovieFrame(MovieReader *movie)
+{
+  uint32_t value;
+  if (movie->repeatleft == 0)
+  {
+    if ((movie->pos >= movie->end) || (*movie->pos == MOVIE_END))
+    {
+      return false;
+    }
+    if (*movie->pos++ == MOVIE_FRAME)
+    {
+      movie->pos = GetVarint(movie->pos, movie->end, &value);
+      movie->lastevents = movie->pos;
+      movie->lastcount = value;
+      movie->pos = ReplayEvents(movie->lastevents, movie->end, movie->lastcount, true);
+      return true;
+    }
+    movie->pos = GetVarint(movie->pos, movie->end, &value);
+    movie->repeatleft = value;
+    if (movie->repeatleft == 0)
+    {
+      return true;
+    }
+  }
+  ReplayEvents(movie->lastevents, movie->end, movie->lastcount, true);
+  movie->repeatleft--;
+  return true;
+}
+
+bool StartMovieRecording(const char *filename)
+{
+  uint8_t header[MOVIE_HEADER_SIZE];
+  int64_t date = (int64_t) time(NULL);
+  int i;
+  StopMovie();
+  moviefile = filestream_open(filename, RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+  if (moviefile == NULL)
+  {
+    LOG_ERROR("Cannot create movie file %s.\n", filename);
+    return false;
+  }
+  memcpy(header, MOVIE_MAGIC, 4);
+  header[4] = MOVIE_VERSION;
+  header[5] = GetThomsonModel();
+  for (i = 0; i < 8; i++)
+  {
+    header[6 + i] = (date >> (8 * i)) & 0xff;
+  }
+  filestream_write(moviefile, header, MOVIE_HEADER_SIZE);
+  SetEmulatedDate(date);
+  Hardreset();
+  frame = 0;
+  currentframe.size = 0;
+  currentframe.count = 0;
+  previousframe.size = 0;
+  previousframe.count = 0;
+  repeat = 0;
+  mode = MOVIE_RECORDING;
+  SetInputFilter(RecordFilter);
+  LOG_INFO("Recording movie %s.\n", filename);
+  return true;
+}
+
+bool StartMoviePlayback(const char *filename)
+{
+  StopMovie();
+  player = OpenMovie(filename);
+  if (player == NULL)
+  {
+    return false;
+  }
+  SetThomsonModel(GetMovieModel(player));
+  SetEmulatedDate(GetMovieDate(player));
+  Hardreset();
+  frame = 0;
+  mode = MOVIE_PLAYING;
+  SetInputFilter(PlaybackFilter);
+  LOG_INFO("Playing movie %s.\n", filename);
+  return true;
+}
+
+void StopMovie(void)
+{
+  if (mode == MOVIE_RECORDING)
+  {
+    uint8_t end = MOVIE_END;
+    FlushRepeat();
+    filestream_write(moviefile, &end, 1);
+    filestream_close(moviefile);
+    moviefile = NULL;
+    free(currentframe.data);
+    free(previousframe.data);
+    memset(&currentframe, 0, sizeof(currentframe));
+    memset(&previousframe, 0, sizeof(previousframe));
+    LOG_INFO("Movie recorded (%u frames).\n", frame);
+  }
+  else if (mode == MOVIE_PLAYING)
+  {
+    CloseMovie(player);
+    player = NULL;
+    LOG_INFO("End of movie (%u frames).\n", frame);
+  }
+  mode = MOVIE_NONE;
+  SetInputFilter(NULL);
+  SetEmulatedDate(0);
+}
+
+bool IsMoviePlaying(void)
+{
+  return mode == MOVIE_PLAYING;
+}
+
+bool IsMovieActive(void)
+{
+  return mode != MOVIE_NONE;
+}
+
+void MovieBeginFrame(void)
+{
+  bool replayed;
+  if (mode != MOVIE_PLAYING)
+  {
+    return;
+  }
+  replaying = true;
+  replayed = ReplayMovieFrame(player);
+  replaying = false;
+  if (!replayed)
+  {
+    // The input of the frontend is used again from this frame
+    StopMovie();
+  }
+}
+
+void MovieEndFrame(void)
+{
+  if (mode == MOVIE_RECORDING)
+  {
+    if ((currentframe.count == previousframe.count) && (currentframe.size == previousframe.size)
+        && ((currentframe.size == 0) || (memcmp(currentframe.data, previousframe.data, currentframe.size) == 0)))
+    {
+      repeat++;
+    }
+    else
+    {
+      FrameEvents swap;
+      FlushRepeat();
+      WriteVarintItem(MOVIE_FRAME, currentframe.count);
+      filestream_write(moviefile, currentframe.data, currentframe.size);
+      swap = previousframe;
+      previousframe = currentframe;
+      currentframe = swap;
+    }
+    currentframe.size = 0;
+    currentframe.count = 0;
+  }
+  if (mode != MOVIE_NONE)
+  {
+    frame++;
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Input movies: recording and replay of the input events */
+
+#ifndef __MOVIE_H
+#define __MOVIE_H
+
+#include "boolean.h"
+#include "motoemulator.h"
+
+// Movie file opened for a replay without the libretro interface
+typedef struct MovieReader MovieReader;
+
+// Starts the recording of the input events in a file.
+// The emulated computer is hardreset and its date is pinned, so that the
+// recording can be replayed from the same state (with the same media loaded).
+bool StartMovieRecording(const char *filename);
+// Starts the replay of a movie file: the emulated computer is hardreset
+// with the recorded model and date, and the input events received from the
+// frontend are ignored until the end of the movie.
+bool StartMoviePlayback(const char *filename);
+// Stops the recording (the file is then complete) or the replay
+void StopMovie(void);
+// Returns true during the replay of a movie
+bool IsMoviePlaying(void);
+// Returns true during the recording or the replay of a movie: the state of the
+// emulated computer must then only change by emulating frames
+bool IsMovieActive(void);
+// To be called at the beginning and at the end of each frame
+void MovieBeginFrame(void);
+void MovieEndFrame(void);
+
+// Reads a movie file. Returns NULL if it cannot be read or is not valid.
+MovieReader *OpenMovie(const char *filename);
+void CloseMovie(MovieReader *movie);
+// Model and date written in the ROM of the recording: the computer must be
+// hardreset with them (and with the same media loaded) before the replay
+ThomsonModel GetMovieModel(const MovieReader *movie);
+int64_t GetMovieDate(const MovieReader *movie);
+// Number of frames of the movie
+unsigned int GetMovieLength(const MovieReader *movie);
+// Queues the events of the next frame of the movie in the current machine,
+// before the frame is emulated. Returns false at the end of the movie.
+bool ReplayMovieFrame(MovieReader *movie);
+
+#endif /* __MOVIE_H */
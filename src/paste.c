@@ -0,0 +1,152 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Text pasted on the keyboard of the emulated computer.
+ * The characters are translated into keys of the current model (keymap.c) and
+ * typed with TypeKeyboard: each key is applied as soon as the emulated computer
+ * has read the previous one, which is the fastest rate at which it can receive
+ * them. The text is kept here and queued by blocks, as the queue of the typed
+ * keys is small (it is part of the state of the machine). */
+
+#include <stdlib.h>
+#include <string.h>
+#include <streams/file_stream.h>
+#include "paste.h"
+#include "keymap.h"
+#include "logger.h"
+#include "motoemulator.h"
+
+// Max number of keys typed for one character (SHIFT down, key down, key up, SHIFT up)
+#define KEYS_PER_CHARACTER 4
+
+static char *pastetext = NULL;      //texte colle (termine par un zero)
+static size_t pastelength = 0;      //longueur du texte
+static size_t pasteposition = 0;    //position du prochain caractere a taper
+
+// Mapping ASCII -> scancodes and scancode of the SHIFT key of the current model
+static const short *asciimap(int *shift)
+{
+  switch (GetThomsonModel())
+  {
+    case MO5:
+    case TO7:
+    case TO7_70:
+      *shift = libretroKeyCodeToThomsonMo5ScanCode[RETROK_LSHIFT];
+      return asciiToThomsonMo5ScanCode;
+    case MO6:
+      *shift = libretroKeyCodeToThomsonMo6ScanCode[RETROK_LSHIFT];
+      return asciiToThomsonMo6ScanCode;
+    case PC128:
+      *shift = libretroKeyCodeToThomsonMo6ScanCode[RETROK_LSHIFT];
+      return asciiToThomsonPc128ScanCode;
+    default:
+      *shift = libretroKeyCodeToThomsonToScanCode[RETROK_LSHIFT];
+      return asciiToThomsonToScanCode;
+  }
+}
+
+void PasteText(const char *text)
+{
+  size_t length = strlen(text);
+  char *newtext;
+  if (length == 0) return;
+  // Le texte deja tape est supprime
+  if (pasteposition > 0)
+  {
+    memmove(pastetext, pastetext + pasteposition, pastelength - pasteposition + 1);
+    pastelength -= pasteposition;
+    pasteposition = 0;
+  }
+  newtext = realloc(pastetext, pastelength + length + 1);
+  if (newtext == NULL)
+  {
+    LOG_ERROR("Not enough memory to paste %u characters.\n", (unsigned int) length);
+    return;
+  }
+  pastetext = newtext;
+  memcpy(pastetext + pastelength, text, length + 1);
+  pastelength += length;
+}
+
+bool PasteFile(const char *filename)
+{
+  void *data = NULL;
+  int64_t size;
+  // The data read is terminated by a zero
+  if (!filestream_read_file(filename, &data, &size) || (data == NULL))
+  {
+    LOG_ERROR("Cannot read file %s.\n", filename);
+    return false;
+  }
+  PasteText((const char *) data);
+  free(data);
+  return true;
+}
+
+void StopPaste(void)
+{
+  free(pastetext);
+  pastetext = NULL;
+  pastelength = 0;
+  pasteposition = 0;
+}
+
+bool IsPasting(void)
+{
+  return pasteposition < pastelength;
+}
+
+void UpdatePaste(void)
+{
+  const short *map;
+  int shift, nkeys = 0;
+  bool shifted = false;
+  // Les touches sont ajoutees quand les precedentes ont toutes ete appliquees
+  if (!IsPasting() || IsTyping()) return;
+  map = asciimap(&shift);
+  while ((pasteposition < pastelength) && (nkeys + KEYS_PER_CHARACTER <= TYPED_KEYS_SIZE))
+  {
+    unsigned char c = pastetext[pasteposition++];
+    int key;
+    // Fin de ligne CR LF : une seule touche ENTREE
+    if ((c == '\n') && (pasteposition > 1) && (pastetext[pasteposition - 2] == '\r')) continue;
+    // Caracteres non ASCII (UTF-8 sur plusieurs octets) ignores
+    if ((c >= 0x80) || (map[c] < 0)) continue;
+    key = map[c];
+    // SHIFT reste enfonce pour les caracteres successifs qui l'utilisent
+    if (shifted != ((key & ASCII_SHIFT) != 0))
+    {
+      shifted = !shifted;
+      TypeKeyboard(shift, shifted);
+      nkeys++;
+    }
+    TypeKeyboard(key & 0xff, true);
+    TypeKeyboard(key & 0xff, false);
+    nkeys += 2;
+  }
+  if (shifted)
+  {
+    TypeKeyboard(shift, false);
+  }
+  if (!IsPasting())
+  {
+    StopPaste();
+  }
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* Text pasted on the keyboard of the emulated computer */
+
+#ifndef __PASTE_H
+#define __PASTE_H
+
+#include "boolean.h"
+
+// Types a text (UTF-8) on the keyboard, after the text already pasted.
+// The characters that have no key on the keyboard of the current model
+// (accents, non-ASCII characters...) are ignored.
+void PasteText(const char *text);
+// Types the content of a text file. Returns false if the file cannot be read.
+bool PasteFile(const char *filename);
+// Stops the typing of the pasted text
+void StopPaste(void);
+// Returns true while characters of the pasted text wait to be typed
+bool IsPasting(void);
+// To be called at each frame: the next characters of the text are typed when
+// the emulated computer has read the previous ones
+void UpdatePaste(void);
+
+#endif /* __PASTE_H */
@@ -0,0 +1,368 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Rewind of the emulation.
+ * The last recorded state (state without the RAM and RAM of the model) is kept
+ * in a shadow copy. At the end of each frame, the new state is XORed with the
+ * shadow copy (for the RAM, only the pages written during the frame), and this
+ * delta is compressed (LZ77) and recorded in a ring buffer. Going back one frame
+ * is applying the last recorded delta to the shadow copy. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rewind.h"
+#include "motoemulator.h"
+
+// Max number of frames recorded
+#define REWIND_MAX_RECORDS 32768
+#define RAM_PAGE_SIZE (1 << RAM_PAGE_SHIFT)
+// Each modified RAM page is stored with its number (2 bytes)
+#define DELTA_PAGE_SIZE (2 + RAM_PAGE_SIZE)
+// LZ77 compression: min length of a match, max distance of a match,
+// size of the hash table used to find the matches
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 0xffff
+#define LZ_HASH_BITS 12
+#define LZ_EMPTY 0xffffffff
+// Max size of compressed data
+#define LZ_BOUND(n) ((n) + (n) / 64 + 16)
+
+typedef struct
+{
+  unsigned int offset;  // Position of the compressed delta in the ring buffer
+  unsigned int size;    // Size of the compressed delta
+  unsigned int rawsize; // Size of the delta
+} RewindRecord;
+
+static uint8_t *buffer = NULL;      // Ring buffer of the compressed deltas
+static unsigned int buffersize = 0;
+static unsigned int bufferhead = 0; // Position of the next compressed delta
+static RewindRecord *records = NULL;
+static int firstrecord = 0;         // Oldest record
+static int nrecords = 0;
+static uint8_t *shadowstate = NULL; // Last recorded state without the RAM
+static uint8_t *shadowram = NULL;   // Last recorded RAM
+static unsigned int shadowramsize = 0; // 0 = no recorded state
+static ThomsonModel shadowmodel;    // Model of the recorded states
+static unsigned int hotstatesize;
+static unsigned int checkpoint;     // RAM modifications since the last recorded state
+static uint8_t *delta = NULL;       // Delta being built or applied
+static uint8_t *compressed = NULL;  // Delta being compressed
+
+static uint8_t *PutVarint(uint8_t *p, unsigned int value)
+{
+  while (value >= 0x80)
+  {
+    *p++ = (value & 0x7f) | 0x80;
+    value >>= 7;
+  }
+  *p++ = value;
+  return p;
+}
+
+static const uint8_t *GetVarint(const uint8_t *p, unsigned int *value)
+{
+  int shift = 0;
+  *value = 0;
+  while (*p & 0x80)
+  {
+    *value |= (*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  *value |= *p++ << shift;
+  return p;
+}
+
+// Compression of n bytes of src into dst (LZ_BOUND(n) bytes).
+// The data is a sequence of: number of literals, literals, length of the match
+// (minus LZ_MIN_MATCH), distance of the match (2 bytes), and ends with literals.
+// Returns the size of the compressed data.
+static unsigned int LzCompress(const uint8_t *src, unsigned int n, uint8_t *dst)
+{
+  static uint32_t hashtable[1 << LZ_HASH_BITS];
+  unsigned int i = 0, anchor = 0;
+  uint8_t *p = dst;
+  memset(hashtable, 0xff, sizeof(hashtable));
+  while (i + LZ_MIN_MATCH <= n)
+  {
+    uint32_t sequence, hash, candidate;
+    memcpy(&sequence, src + i, sizeof(sequence));
+    hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+    candidate = hashtable[hash];
+    hashtable[hash] = i;
+    if ((candidate != LZ_EMPTY) && (i - candidate <= LZ_MAX_OFFSET)
+        && (memcmp(src + candidate, src + i, LZ_MIN_MATCH) == 0))
+    {
+      unsigned int length = LZ_MIN_MATCH;
+      while ((i + length < n) && (src[candidate + length] == src[i + length]))
+      {
+        length++;
+      }
+      p = PutVarint(p, i - anchor);
+      memcpy(p, src + anchor, i - anchor);
+      p += i - anchor;
+      p = PutVarint(p, length - LZ_MIN_MATCH);
+      *p++ = (i - candidate) & 0xff;
+      *p++ = (i - candidate) >> 8;
+      i += length;
+      anchor = i;
+    }
+    else
+    {
+      i++;
+    }
+  }
+  p = PutVarint(p, n - anchor);
+  memcpy(p, src + anchor, n - anchor);
+  p += n - anchor;
+  return p - dst;
+}
+
+// Decompression of n bytes into dst
+static void LzDecompress(const uint8_t *src, uint8_t *dst, unsigned int n)
+{
+  unsigned int i = 0, length, offset;
+  for (;;)
+  {
+    src = GetVarint(src, &length);
+    memcpy(dst + i, src, length);
+    src += length;
+    i += length;
+    if (i >= n) break;
+    src = GetVarint(src, &length);
+    length += LZ_MIN_MATCH;
+    offset = src[0] | (src[1] << 8);
+    src += 2;
+    // The match may overlap the data being copied (repeated bytes)
+    while (length--)
+    {
+      dst[i] = dst[i - offset];
+      i++;
+    }
+  }
+}
+
+static void DropOldestRecord(void)
+{
+  firstrecord = (firstrecord + 1) % REWIND_MAX_RECORDS;
+  nrecords--;
+}
+
+// Reserves size bytes in the ring buffer for a new record,
+// by dropping the oldest records if necessary
+static unsigned int AllocateRecord(unsigned int size)
+{
+  unsigned int offset = bufferhead;
+  RewindRecord *oldest;
+  if (offset + size > buffersize)
+  {
+    // The end of the buffer is left unused: the oldest records stored there are dropped
+    while ((nrecords > 0) && (records[firstrecord].offset >= offset))
+    {
+      DropOldestRecord();
+    }
+    offset = 0;
+  }
+  while (nrecords > 0)
+  {
+    oldest = &records[firstrecord];
+    if ((nrecords < REWIND_MAX_RECORDS)
+        && ((oldest->offset >= offset + size) || (oldest->offset + oldest->size <= offset)))
+    {
+      break;
+    }
+    DropOldestRecord();
+  }
+  bufferhead = offset + size;
+  return offset;
+}
+
+static void FreeRewindBuffer(void)
+{
+  free(buffer);
+  free(records);
+  free(shadowstate);
+  free(shadowram);
+  free(delta);
+  free(compressed);
+  buffer = NULL;
+  records = NULL;
+  shadowstate = NULL;
+  shadowram = NULL;
+  delta = NULL;
+  compressed = NULL;
+  buffersize = 0;
+}
+
+void SetRewindBufferSize(unsigned int size)
+{
+  unsigned int maxdeltasize;
+  if (size == buffersize)
+  {
+    return;
+  }
+  FreeRewindBuffer();
+  ClearRewind();
+  if (size == 0)
+  {
+    return;
+  }
+  hotstatesize = toemulator_hotstate_size();
+  maxdeltasize = hotstatesize + RAM_PAGE_NUMBER * DELTA_PAGE_SIZE;
+  buffer = malloc(size);
+  records = malloc(REWIND_MAX_RECORDS * sizeof(RewindRecord));
+  shadowstate = malloc(hotstatesize);
+  shadowram = malloc(RAM_SIZE);
+  delta = malloc(maxdeltasize);
+  compressed = malloc(LZ_BOUND(maxdeltasize));
+  if ((buffer == NULL) || (records == NULL) || (shadowstate == NULL)
+      || (shadowram == NULL) || (delta == NULL) || (compressed == NULL))
+  {
+    FreeRewindBuffer();
+    return;
+  }
+  buffersize = size;
+}
+
+void ClearRewind(void)
+{
+  firstrecord = 0;
+  nrecords = 0;
+  bufferhead = 0;
+  shadowramsize = 0;
+}
+
+void PushRewindState(void)
+{
+  unsigned int ramsize = GetRamSize();
+  char *ram = GetRam();
+  unsigned int rawsize, size, i;
+  int page, npages;
+  RewindRecord *record;
+  if (buffer == NULL)
+  {
+    return;
+  }
+  if ((shadowramsize == 0) || (GetThomsonModel() != shadowmodel))
+  {
+    // First recorded state (or new model): the whole state is copied
+    ClearRewind();
+    toemulator_serialize_hotstate(shadowstate);
+    memcpy(shadowram, ram, ramsize);
+    shadowramsize = ramsize;
+    shadowmodel = GetThomsonModel();
+    checkpoint = RamCheckpoint();
+    return;
+  }
+
+  // Delta of the state without the RAM
+  toemulator_serialize_hotstate(delta);
+  for (i = 0; i < hotstatesize; i++)
+  {
+    uint8_t c = delta[i];
+    delta[i] ^= shadowstate[i];
+    shadowstate[i] = c;
+  }
+  rawsize = hotstatesize;
+  // Delta of the RAM pages written since the last recorded state
+  npages = ramsize >> RAM_PAGE_SHIFT;
+  for (page = 0; page < npages; page++)
+  {
+    uint8_t *s = shadowram + (page << RAM_PAGE_SHIFT);
+    const uint8_t *r = (const uint8_t *) ram + (page << RAM_PAGE_SHIFT);
+    if (IsRamPageModified(page, checkpoint) && (memcmp(s, r, RAM_PAGE_SIZE) != 0))
+    {
+      uint8_t *p = delta + rawsize;
+      p[0] = page & 0xff;
+      p[1] = page >> 8;
+      for (i = 0; i < RAM_PAGE_SIZE; i++)
+      {
+        p[2 + i] = s[i] ^ r[i];
+      }
+      memcpy(s, r, RAM_PAGE_SIZE);
+      rawsize += DELTA_PAGE_SIZE;
+    }
+  }
+  checkpoint = RamCheckpoint();
+
+  size = LzCompress(delta, rawsize, compressed);
+  if (size > buffersize)
+  {
+    // Too big for the buffer: the previous states can no longer be restored
+    firstrecord = 0;
+    nrecords = 0;
+    bufferhead = 0;
+    return;
+  }
+  record = &records[(firstrecord + nrecords) % REWIND_MAX_RECORDS];
+  record->offset = AllocateRecord(size);
+  record->size = size;
+  record->rawsize = rawsize;
+  memcpy(buffer + record->offset, compressed, size);
+  nrecords++;
+}
+
+bool StepBackRewind(void)
+{
+  char *ram = GetRam();
+  int page, npages;
+  unsigned int i;
+  if ((buffer == NULL) || (shadowramsize == 0) || (GetThomsonModel() != shadowmodel))
+  {
+    return false;
+  }
+  npages = shadowramsize >> RAM_PAGE_SHIFT;
+  if (nrecords > 0)
+  {
+    // The last delta is applied to the shadow copy, which becomes the previous state
+    RewindRecord *record = &records[(firstrecord + nrecords - 1) % REWIND_MAX_RECORDS];
+    const uint8_t *p;
+    LzDecompress(buffer + record->offset, delta, record->rawsize);
+    for (i = 0; i < hotstatesize; i++)
+    {
+      shadowstate[i] ^= delta[i];
+    }
+    for (p = delta + hotstatesize; p < delta + record->rawsize; p += DELTA_PAGE_SIZE)
+    {
+      uint8_t *s;
+      page = p[0] | (p[1] << 8);
+      s = shadowram + (page << RAM_PAGE_SHIFT);
+      for (i = 0; i < RAM_PAGE_SIZE; i++)
+      {
+        s[i] ^= p[2 + i];
+      }
+      MarkRamPageModified(page);
+    }
+    bufferhead = record->offset;
+    nrecords--;
+  }
+  // The RAM pages which differ from the shadow copy are restored
+  for (page = 0; page < npages; page++)
+  {
+    if (IsRamPageModified(page, checkpoint))
+    {
+      memcpy(ram + (page << RAM_PAGE_SHIFT), shadowram + (page << RAM_PAGE_SHIFT), RAM_PAGE_SIZE);
+      MarkRamPageModified(page);
+    }
+  }
+  toemulator_unserialize_hotstate(shadowstate);
+  checkpoint = RamCheckpoint();
+  return true;
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of theodore (https://github.com/Zlika/theodore),
+ * a Thomson emulator based on Daniel Coulom's DCTO8D/DCTO9P/DCMO5
+ * emulators (http://dcmoto.free.fr/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Rewind of the emulation */
+
+#ifndef __REWIND_H
+#define __REWIND_H
+
+#include "boolean.h"
+
+// Sets the size of the rewind buffer in bytes (0 = rewind disabled).
+// The buffer is emptied.
+void SetRewindBufferSize(unsigned int size);
+// Empties the rewind buffer (when a new game is loaded).
+// It is also emptied when the emulated model changes.
+void ClearRewind(void);
+// Records the current state of the emulator (at the end of each frame)
+void PushRewindState(void);
+// Restores the state recorded before the last one, or the oldest state
+// if the buffer is empty. Returns false if there is no state at all.
+bool StepBackRewind(void);
+
+#endif /* __REWIND_H */
@@ -24,51 +24,98 @@
 #include <string.h>
 #include "motoemulator.h"
 #include "video.h"
+#include "machine.h"
 
 #define NB_VIDEO_MODES 6
 #define SEGMENT_SIZE  16
+#define NB_PIXEL_FORMATS 2
 
-typedef struct { int w, h; pixel_fmt_t* pixels;} Surface;
+// global variables (of the current machine) ////////////////////////////////
+#define palettergb (machine->video.palettergb)                 //intensites r,v,b (0-15) des couleurs de la palette
+#define pcolor16 (machine->video.pcolor16)                     //couleurs de la palette au format 16 bits
+#define pcolor32 (machine->video.pcolor32)                     //couleurs de la palette au format XRGB8888
+#define currentvideomemory (machine->video.currentvideomemory) //index octet courant en memoire video thomson
+#define currentlinesegment (machine->video.currentlinesegment) //numero de l'octet courant dans la ligne video
+#define pcurrentpixel (machine->video.pcurrentpixel)           //pointeur ecran : pixel courant
+#define pcurrentline (machine->video.pcurrentline)             //pointeur ecran : debut ligne courante
+#define pmin (machine->video.pmin)                             //pointeur ecran : premier pixel
+#define pmax (machine->video.pmax)                             //pointeur ecran : dernier pixel + 1
+#define pitch (machine->video.pitch)                           //nombre d'octets entre deux lignes ecran
+#define pixelformat (machine->video.pixelformat)
+#define pixelsize (machine->video.pixelsize)
+#define videomode (machine->video.videomode)
+#define displaydirty (machine->video.displaydirty)             //affichage modifie autrement que par ecriture en memoire video
+#define lastframedirty (machine->video.lastframedirty)         //trame precedente modifiee
+#define framecheckpoint (machine->video.framecheckpoint)       //point de controle des ecritures en RAM a la fin de la trame precedente
+#define ram (machine->ram)                                     //ram 512K
+#define pagevideo (machine->pagevideo)                         //pointeur page video affichee
+#define videolinecycle (machine->state.videolinecycle)         //compteur ligne (0-63)
+#define videolinenumber (machine->state.videolinenumber)       //numero de ligne video affichee (0-311)
+#define bordercolor (machine->state.bordercolor)               //couleur de la bordure de l'ecran
 
-// global variables //////////////////////////////////////////////////////////
-static Surface screen;
-static pixel_fmt_t pcolor[20][8];     //couleurs BGRA de la palette (pour 8 pixels)
-static int currentvideomemory;        //index octet courant en memoire video thomson
-static int currentlinesegment;        //numero de l'octet courant dans la ligne video
-static pixel_fmt_t *pcurrentpixel;    //pointeur ecran : pixel courant
-static pixel_fmt_t *pcurrentline;     //pointeur ecran : debut ligne courante
-static pixel_fmt_t *pmin;             //pointeur ecran : premier pixel
-static pixel_fmt_t *pmax;             //pointeur ecran : dernier pixel + 1
-
-// Forward declarations
-static void Decode320x16(void);
-static void Decode320x4(void);
-static void Decode320x4special(void);
-static void Decode160x16(void);
-static void Decode640x2(void);
-static void Decode320x16MO5(void);
 // Current video memory decoding function
-static void (*Decodevideo)(void) = Decode320x16;
-// Array of the different video memory decoding functions (indexed by the video mode)
-static void (*DecodevideoModes[NB_VIDEO_MODES])(void) =
-  { Decode320x16, Decode320x4, Decode320x4special,
-    Decode160x16, Decode640x2, Decode320x16MO5 };
+#define Decodevideo (machine->video.decodevideo)
 
 //definition des intensites pour correction gamma (circuit palette EF9369 + circuit d'adaptation TEA5114)
 static const int intens[16] = {0,100,127,147,163,179,191,203,215,223,231,239,243,247,251,255};
 
 #if defined(SUPPORT_ABGR1555)
 // Hack for PS2 that expects ABGR1555 encoded pixels
-#define PIXEL(r,g,b) ((((b) << 7) &  0x7C00) | (((g) << 2) & 0x3e0) | (((r) >> 3) & 0x1f))
+#define PIXEL16(r,g,b) ((((b) << 7) &  0x7C00) | (((g) << 2) & 0x3e0) | (((r) >> 3) & 0x1f))
 #else
 // Returns the RGB565 value of a pixel.
-#define PIXEL(r,g,b) ((((r) << 8) &  0xf800) | (((g) << 3) & 0x7e0) | (((b) >> 3) & 0x1f))
+#define PIXEL16(r,g,b) ((((r) << 8) &  0xf800) | (((g) << 3) & 0x7e0) | (((b) >> 3) & 0x1f))
 #endif
+// Returns the XRGB8888 value of a pixel.
+#define PIXEL32(r,g,b) ((uint32_t) (((r) << 16) | ((g) << 8) | (b)))
+
+// Instantiation of the rendering functions for each pixel format
+#define VIDEO_FN_CONCAT(name, suffix) name##_##suffix
+#define VIDEO_FN_EXPAND(name, suffix) VIDEO_FN_CONCAT(name, suffix)
+#define VIDEO_FN(name) VIDEO_FN_EXPAND(name, PIXEL_SUFFIX)
+
+#define PIXEL_T uint16_t
+#define PCOLOR pcolor16
+#define PIXEL_SUFFIX 16
+#include "video_render.inc"
+#undef PIXEL_T
+#undef PCOLOR
+#undef PIXEL_SUFFIX
+
+#define PIXEL_T uint32_t
+#define PCOLOR pcolor32
+#define PIXEL_SUFFIX 32
+#include "video_render.inc"
+#undef PIXEL_T
+#undef PCOLOR
+#undef PIXEL_SUFFIX
+
+// Rendering functions (indexed by the pixel format)
+static void (*const *const DecodevideoFormats[NB_PIXEL_FORMATS])(void) =
+  { DecodevideoModes_16, DecodevideoModes_32 };
+static void (*const DisplaysegmentFormats[NB_PIXEL_FORMATS])(void) =
+  { Displaysegment_16, Displaysegment_32 };
+static void (*const NextlineFormats[NB_PIXEL_FORMATS])(void) =
+  { Nextline_16, Nextline_32 };
+
+// Calcul d'une couleur de la palette dans tous les formats de pixel
+static void SetColor(int n, int r, int v, int b)
+{
+  if ((palettergb[n][0] != r) || (palettergb[n][1] != v) || (palettergb[n][2] != b))
+  {
+    displaydirty = true;
+  }
+  palettergb[n][0] = r;
+  palettergb[n][1] = v;
+  palettergb[n][2] = b;
+  pcolor16[n] = PIXEL16(intens[r], intens[v], intens[b]);
+  pcolor32[n] = PIXEL32(intens[r], intens[v], intens[b]);
+}
 
 // Initialisation palette ////////////////////////////////////////////////////
 void InitPalette(void)
 {
-  int i, j;
+  int i;
   // A la mise sous tension, le circuit palette est programmé pour restituer
   // les couleurs fondamentales du TO7/70 :
   // 0 noir, 1 rouge, 2 vert, 3 jaune, 4 bleu, 5 magenta, 6 cyan, 7 blanc
@@ -79,254 +126,198 @@ void InitPalette(void)
   // Calcul de la palette
   for(i = 0; i < 19; i++)
   {
-    for(j = 0; j < 8; j++)
-    {
-      pcolor[i][j] = PIXEL(intens[r[i]], intens[g[i]], intens[b[i]]);
-    }
+    SetColor(i, r[i], g[i], b[i]);
   }
 }
 
 // Modification de la palette ////////////////////////////////////////////////
 void Palette(int n, int r, int v, int b)
 {
-  int i;
-  for(i = 0; i < 8; i++)
-  {
-    pcolor[n][i] = PIXEL(intens[r], intens[v], intens[b]);
-  }
+  SetColor(n, r, v, b);
 }
 
 void SetVideoMode(enum VideoMode mode)
 {
-  Decodevideo = DecodevideoModes[mode];
-}
-
-// Decodage octet video mode 320x16 MO5 //////////////////////////////////////
-static void Decode320x16MO5(void)
-{
-  int i, c0, c1, shape;
-  pixel_fmt_t c;
-  c0 = pagevideo[currentvideomemory] & 0x0f;        //background color index
-  c1 = (pagevideo[currentvideomemory] >> 4) & 0x0f; //foreground color index
-  shape = pagevideo[currentvideomemory++ | 0x2000];
-  for(i = 7; i >= 0; i--)
+  if (mode != videomode)
   {
-    c = *((pixel_fmt_t *)(pcolor + (((shape >> i) & 1) ? c1 : c0)));
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
+    displaydirty = true;
   }
+  videomode = mode;
+  Decodevideo = DecodevideoFormats[pixelformat][mode];
 }
 
-// Decodage octet video mode 320x16 standard /////////////////////////////////
-static void Decode320x16(void)
+void SetVideoPixelFormat(enum VideoPixelFormat format)
 {
-  int i, c0, c1, color, shape;
-  pixel_fmt_t c;
-  shape = pagevideo[currentvideomemory | 0x2000];
-  color = pagevideo[currentvideomemory++];
-  c0 = (color & 0x07) | ((~color & 0x80) >> 4);        //background
-  c1 = ((color >> 3) & 0x07) | ((~color & 0x40) >> 3); //foreground
-  for(i = 7; i >= 0; i--)
-  {
-    c = *((pixel_fmt_t *)(pcolor + (((shape >> i) & 1) ? c1 : c0)));
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
-  }
+  pixelformat = format;
+  pixelsize = (format == VIDEO_PIXEL_XRGB8888) ? sizeof(uint32_t) : sizeof(uint16_t);
+  machine->video.displaysegment = DisplaysegmentFormats[format];
+  machine->video.nextline = NextlineFormats[format];
+  Decodevideo = DecodevideoFormats[format][videomode];
+  displaydirty = true;
 }
 
-// Decodage octet video mode bitmap4 320x200 4 couleurs //////////////////////
-static void Decode320x4(void)
+unsigned int GetVideoPixelSize(void)
 {
-  int i, c0, c1;
-  pixel_fmt_t c;
-  c0 = pagevideo[currentvideomemory | 0x2000]; //color1
-  c1 = pagevideo[currentvideomemory++];        //color2
-  for(i = 7; i >= 0; i--)
-  {
-    c = *((pixel_fmt_t *)(pcolor + (((c0 << 1) >> i & 2) | (c1 >> i & 1))));
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
-  }
+  return pixelsize;
 }
 
-// Decodage octet video mode bitmap4 special 320x200 4 couleurs //////////////
-static void Decode320x4special(void)
+static void InitScreen(void)
 {
-  int i, c0;
-  pixel_fmt_t c;
-  c0 = pagevideo[currentvideomemory | 0x2000] << 8;
-  c0 |= pagevideo[currentvideomemory++] & 0xff;
-  for(i = 14; i >= 0; i -= 2)
+  pcurrentline = pmin;    //initialisation pointeur ligne courante
+  pcurrentpixel = pmin;   //initialisation pointeur pixel courant
+  currentlinesegment = 0; //initialisation numero d'octet dans la ligne
+  currentvideomemory = 0; //initialisation index en memoire video thomson
+  videolinecycle = 52;
+  for(videolinenumber = 48; videolinenumber < 264; videolinenumber++)
   {
-    c = *((pixel_fmt_t *)(pcolor + (c0 >> i & 3)));
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
+    machine->video.displaysegment();
+    machine->video.nextline();
   }
+  videolinecycle = 0; videolinenumber = 0;
 }
 
-// Decodage octet video mode bitmap16 160x200 16 couleurs ////////////////////
-static void Decode160x16(void)
+void SetLibRetroVideoBuffer(void *video_buffer)
 {
-  int i, c0;
-  pixel_fmt_t c;
-  c0 = pagevideo[currentvideomemory | 0x2000] << 8;
-  c0 |= pagevideo[currentvideomemory++] & 0xff;
-  for(i = 12; i >= 0; i -= 4)
-  {
-    c = *((pixel_fmt_t *)(pcolor + (c0 >> i & 0x0f)));
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
-    *pcurrentpixel++ = c;
-  }
+  pitch = XBITMAP * pixelsize;
+  pmin = (uint8_t *) video_buffer;
+  pmax = pmin + YBITMAP * pitch;
+  memset(pmin, 0, YBITMAP * pitch);
+  InitScreen();
+  displaydirty = true;
 }
 
-// Decodage octet video mode 640x200 2 couleurs //////////////////////////////
-static void Decode640x2(void)
+void RetargetVideoBuffer(void *video_buffer, unsigned int video_pitch)
 {
-  int i, c0;
-  pixel_fmt_t c;
-  c0 = pagevideo[currentvideomemory | 0x2000] << 8;
-  c0 |= pagevideo[currentvideomemory++] & 0xff;
-  for(i = 15; i >= 0; i--)
+  uint8_t *newmin = (uint8_t *) video_buffer;
+  // (no framebuffer yet for a machine that has not been displayed)
+  int line = (pitch != 0) ? (pcurrentline - pmin) / pitch : 0;
+  int column = pcurrentpixel - pcurrentline;
+  if ((newmin == pmin) && ((int) video_pitch == pitch))
   {
-    c = *((pixel_fmt_t *)(pcolor + (((c0 >> i) & 1) ? 1 : 0)));
-    *pcurrentpixel++ = c;
+    return;
   }
+  // Called between two frames: the new framebuffer does not need
+  // the content of the previous one, it is entirely rendered again.
+  pitch = (int) video_pitch;
+  pmin = newmin;
+  pmax = pmin + YBITMAP * pitch;
+  pcurrentline = pmin + line * pitch;
+  pcurrentpixel = pcurrentline + column;
 }
 
-// Creation d'un segment de bordure ///////////////////////////////////////////
-static void Displayborder(void)
+void ResyncVideoBeam(void)
 {
-  int i;
-  pixel_fmt_t c;
-  c = *((pixel_fmt_t *)(pcolor + bordercolor));
-  for (i = 0; i < SEGMENT_SIZE; i++)
+  // Les lignes 48 a 263 sont affichees sur deux lignes ecran chacune,
+  // les lignes 56 a 255 lisent 40 octets de memoire video chacune
+  if ((videolinenumber > 47) && (videolinenumber < 264))
   {
-    *pcurrentpixel++ = c;
+    pcurrentline = pmin + (videolinenumber - 48) * 2 * pitch;
+    if (videolinenumber < 56) currentvideomemory = 0;
+    else if (videolinenumber < 256) currentvideomemory = (videolinenumber - 56) * 40;
+    else currentvideomemory = 200 * 40;
   }
-  currentlinesegment++;
-}
-
-// Creation d'un segment de ligne d'ecran /////////////////////////////////////
-void Displaysegment(void)
-{
-  int segmentmax;
-  segmentmax = videolinecycle - 10;
-  if(segmentmax > 42) segmentmax = 42;
-  while(currentlinesegment < segmentmax)
+  else
   {
-    if(videolinenumber < 56) {Displayborder(); continue;}
-    if(videolinenumber > 255) {Displayborder(); continue;}
-    if(currentlinesegment == 0) {Displayborder(); continue;}
-    if(currentlinesegment == 41) {Displayborder(); continue;}
-    Decodevideo(); currentlinesegment++;
+    pcurrentline = pmin;
+    currentvideomemory = 0;
   }
+  pcurrentpixel = pcurrentline;
+  currentlinesegment = 0;
 }
 
-// Changement de ligne ecran //////////////////////////////////////////////////
-void Nextline(void)
+void MarkDisplayDirty(void)
 {
-  pixel_fmt_t *p0, *p1;
-  p1 = pmin + (videolinenumber - 47) * 2 * XBITMAP;
-  if(videolinenumber == 263) p1 = pmax;
-  p0 = pcurrentline;
-  pcurrentline += XBITMAP;
-  while(pcurrentline < p1)
-  {
-    memcpy(pcurrentline, p0, sizeof(pixel_fmt_t) * XBITMAP);
-    pcurrentline += XBITMAP;
-  }
-  if(pcurrentline == pmax)
-  {
-    pcurrentline = pmin;    //initialisation pointeur ligne courante
-    currentvideomemory = 0; //initialisation index en memoire video thomson
-  }
-  pcurrentpixel = pcurrentline;
-  currentlinesegment = 0;
+  displaydirty = true;
 }
 
-static void InitScreen(void)
+bool IsFrameDuplicate(void)
 {
-  pcurrentline = pmin;    //initialisation pointeur ligne courante
-  pcurrentpixel = pmin;   //initialisation pointeur pixel courant
-  currentlinesegment = 0; //initialisation numero d'octet dans la ligne
-  currentvideomemory = 0; //initialisation index en memoire video thomson
-  videolinecycle = 52;
-  for(videolinenumber = 48; videolinenumber < 264; videolinenumber++)
+  // Les ecritures en memoire video et les changements de palette, de mode
+  // ou de bordure pendant une trame peuvent avoir lieu apres le passage du
+  // spot : la trame n'est identique a la precedente que si ni elle ni la
+  // precedente n'ont ete modifiees.
+  int firstpage = (pagevideo - ram) >> RAM_PAGE_SHIFT;
+  int i;
+  bool dirty = displaydirty;
+  bool duplicate;
+  for (i = 0; !dirty && (i < (0x4000 >> RAM_PAGE_SHIFT)); i++)
   {
-    Displaysegment();
-    Nextline();
+    dirty = IsRamPageModified(firstpage + i, framecheckpoint);
   }
-  videolinecycle = 0; videolinenumber = 0;
+  framecheckpoint = RamCheckpoint();
+  duplicate = !dirty && !lastframedirty;
+  lastframedirty = dirty;
+  displaydirty = false;
+  return duplicate;
 }
 
-void SetLibRetroVideoBuffer(pixel_fmt_t *video_buffer)
+// Etat du module video dans les sauvegardes.
+// Offsets are stored in pixels (with a pitch of XBITMAP pixels)
+// to be independent of the pixel format and of the framebuffer.
+typedef struct
 {
-  screen.w = XBITMAP;
-  screen.h = YBITMAP;
-  screen.pixels = video_buffer;
-
-  pmin = screen.pixels;
-  pmax = pmin + XBITMAP * YBITMAP;
-  memset(screen.pixels, 0, XBITMAP * YBITMAP);
-  InitScreen();
-}
+  uint8_t palette[20][3];
+  int videomemory;
+  int linesegment;
+  int pcurrentpixelOffset;
+  int pcurrentlineOffset;
+  int decodeVideoIndex;
+} VideoState;
 
 unsigned int video_serialize_size(void)
 {
-  return sizeof(pcolor) + sizeof(currentvideomemory) + sizeof(currentlinesegment)
-      + sizeof(int) + sizeof(int) + sizeof(int);
+  return sizeof(VideoState);
 }
 
 void video_serialize(void *data)
 {
-  int offset = 0;
-  int pcurrentpixelOffset = pcurrentpixel - pmin;
-  int pcurrentlineOffset = pcurrentline - pmin;
-  int decodeVideoIndex = 0;
-  int i;
-  char *buffer = (char *) data;
-  memcpy(buffer+offset, pcolor, sizeof(pcolor));
-  offset += sizeof(pcolor);
-  memcpy(buffer+offset, &currentvideomemory, sizeof(currentvideomemory));
-  offset += sizeof(currentvideomemory);
-  memcpy(buffer+offset, &currentlinesegment, sizeof(currentlinesegment));
-  offset += sizeof(currentlinesegment);
-  memcpy(buffer+offset, &pcurrentpixelOffset, sizeof(pcurrentpixelOffset));
-  offset += sizeof(pcurrentpixelOffset);
-  memcpy(buffer+offset, &pcurrentlineOffset, sizeof(pcurrentlineOffset));
-  offset += sizeof(pcurrentlineOffset);
-  for (i = 0; i < NB_VIDEO_MODES; i++)
+  VideoState state;
+  // (no framebuffer yet for a machine that has not been displayed)
+  int line = (pitch != 0) ? (pcurrentline - pmin) / pitch : 0;
+  memset(&state, 0, sizeof(state));
+  memcpy(state.palette, palettergb, sizeof(palettergb));
+  state.videomemory = currentvideomemory;
+  state.linesegment = currentlinesegment;
+  state.pcurrentlineOffset = line * XBITMAP;
+  state.pcurrentpixelOffset = state.pcurrentlineOffset + (pcurrentpixel - pcurrentline) / pixelsize;
+  state.decodeVideoIndex = videomode;
+  memcpy(data, &state, sizeof(state));
+}
+
+bool video_state_valid(const void *data)
+{
+  VideoState state;
+  int i, j, line, column;
+  memcpy(&state, data, sizeof(state));
+  for (i = 0; i < 20; i++)
   {
-    if (Decodevideo == DecodevideoModes[i])
+    for (j = 0; j < 3; j++)
     {
-      decodeVideoIndex = i;
-      break;
+      if (state.palette[i][j] > 15) return false;
     }
   }
-  memcpy(buffer+offset, &decodeVideoIndex, sizeof(decodeVideoIndex));
+  line = state.pcurrentlineOffset / XBITMAP;
+  column = state.pcurrentpixelOffset - state.pcurrentlineOffset;
+  return (state.videomemory >= 0) && (state.videomemory < 0x2000)
+      && (state.linesegment >= 0) && (state.linesegment <= 42)
+      && (state.pcurrentlineOffset >= 0) && (state.pcurrentlineOffset % XBITMAP == 0) && (line < YBITMAP)
+      && (column >= 0) && (column <= XBITMAP)
+      && (state.decodeVideoIndex >= 0) && (state.decodeVideoIndex < NB_VIDEO_MODES);
 }
 
 void video_unserialize(const void *data)
 {
-  int offset = 0;
-  int pcurrentpixelOffset;
-  int pcurrentlineOffset;
-  int decodeVideoIndex;
-  const char *buffer = (const char *) data;
-  memcpy(pcolor, buffer+offset, sizeof(pcolor));
-  offset += sizeof(pcolor);
-  memcpy(&currentvideomemory, buffer+offset, sizeof(currentvideomemory));
-  offset += sizeof(currentvideomemory);
-  memcpy(&currentlinesegment, buffer+offset, sizeof(currentlinesegment));
-  offset += sizeof(currentlinesegment);
-  memcpy(&pcurrentpixelOffset, buffer+offset, sizeof(pcurrentpixelOffset));
-  pcurrentpixel = pmin + pcurrentpixelOffset;
-  offset += sizeof(pcurrentpixelOffset);
-  memcpy(&pcurrentlineOffset, buffer+offset, sizeof(pcurrentlineOffset));
-  pcurrentline = pmin + pcurrentlineOffset;
-  offset += sizeof(pcurrentlineOffset);
-  memcpy(&decodeVideoIndex, buffer+offset, sizeof(decodeVideoIndex));
-  Decodevideo = DecodevideoModes[decodeVideoIndex];
+  VideoState state;
+  int i;
+  memcpy(&state, data, sizeof(state));
+  for (i = 0; i < 20; i++)
+  {
+    SetColor(i, state.palette[i][0], state.palette[i][1], state.palette[i][2]);
+  }
+  currentvideomemory = state.videomemory;
+  currentlinesegment = state.linesegment;
+  pcurrentline = pmin + (state.pcurrentlineOffset / XBITMAP) * pitch;
+  pcurrentpixel = pcurrentline + (state.pcurrentpixelOffset - state.pcurrentlineOffset) * pixelsize;
+  SetVideoMode(state.decodeVideoIndex);
+  displaydirty = true;
 }
@@ -23,15 +23,24 @@
 #define __VIDEO_H
 
 #include <stdint.h>
+#include "boolean.h"
 
 #define XBITMAP 672
 #define YBITMAP 432
 
-// RGB565 pixel format = 16bits
-#define pixel_fmt_t uint16_t
+// Pixel formats supported for the framebuffer
+// (RGB565 is ABGR1555 when SUPPORT_ABGR1555 is defined)
+enum VideoPixelFormat { VIDEO_PIXEL_RGB565, VIDEO_PIXEL_XRGB8888 };
 
+// Sets the pixel format of the framebuffer (default=RGB565)
+void SetVideoPixelFormat(enum VideoPixelFormat format);
+// Returns the size in bytes of a pixel of the framebuffer
+unsigned int GetVideoPixelSize(void);
 // Sets the framebuffer to use
-void SetLibRetroVideoBuffer(pixel_fmt_t *video_buffer);
+void SetLibRetroVideoBuffer(void *video_buffer);
+// Renders the next frame in another framebuffer
+// (pitch = length in bytes between two lines)
+void RetargetVideoBuffer(void *video_buffer, unsigned int pitch);
 
 // List of available video modes
 enum VideoMode { VIDEO_320X16, VIDEO_320X4, VIDEO_320X4_SPECIAL,
@@ -40,20 +49,29 @@ enum VideoMode { VIDEO_320X16, VIDEO_320X4, VIDEO_320X4_SPECIAL,
 // Sets the video mode
 void SetVideoMode(enum VideoMode mode);
 
-// Creation d'un segment de ligne d'ecran
-void Displaysegment(void);
-// Changement de ligne ecran
-void Nextline(void);
+// Creation d'un segment de ligne d'ecran et changement de ligne ecran :
+// fonctions du format de pixel courant (machine->video.displaysegment et nextline)
 // Modification de la palette
 void Palette(int n, int r, int v, int b);
 // Initialisation palette
 void InitPalette(void);
+// Signals a change of the display not made through the video memory
+// (border color, displayed video page...)
+void MarkDisplayDirty(void);
+// Moves the rendering position to the current position of the beam
+// (used when the rendering restarts after having been disabled)
+void ResyncVideoBeam(void);
+// Returns true if the frame just rendered is identical to the previous one
+// (must be called once at the end of each frame)
+bool IsFrameDuplicate(void);
 
 // The following functions are used for libretro's save states feature.
 // Returns the amount of data required to serialize the internal state of the video module.
 unsigned int video_serialize_size(void);
 // Serializes the internal state of the video module.
 void video_serialize(void *data);
+// Returns false if the indexes of a serialized state of the video module are out of range.
+bool video_state_valid(const void *data);
 // Unserializes the internal state of the video module.
 void video_unserialize(const void *data);
 
@@ -21,7 +21,7 @@
 #include "ui.h"
 #include "vkeyb_config.h"
 
-static uint16_t blend(uint16_t fg, uint16_t bg, unsigned int alpha)
+static uint16_t blend16(uint16_t fg, uint16_t bg, unsigned int alpha)
 {
   unsigned int fg_r, fg_g, fg_b;
   unsigned int bg_r, bg_g, bg_b;
@@ -76,37 +76,87 @@ static uint16_t blend(uint16_t fg, uint16_t bg, unsigned int alpha)
 #endif
 }
 
+// Expansion of 5 or 6-bit components to 8 bits
+#define EXPAND5(c) (((c) << 3) | ((c) >> 2))
+#define EXPAND6(c) (((c) << 2) | ((c) >> 4))
+
+static uint32_t blend32(uint16_t fg, uint32_t bg, unsigned int alpha)
+{
+  unsigned int fg_r, fg_g, fg_b;
+  unsigned int bg_r, bg_g, bg_b;
+  unsigned int out_r, out_g, out_b;
+
+  // Split foreground into 8-bit components
+#if defined(SUPPORT_ABGR1555)
+  fg_r = EXPAND5(fg & 0x1fu);
+  fg_g = EXPAND5((fg >> 5) & 0x1fu);
+  fg_b = EXPAND5((fg >> 10) & 0x1fu);
+#else
+  fg_r = EXPAND5(fg >> 11);
+  fg_g = EXPAND6((fg >> 5) & 0x3fu);
+  fg_b = EXPAND5(fg & 0x1fu);
+#endif
+
+  if (alpha == 255)
+  {
+    return (fg_r << 16) | (fg_g << 8) | fg_b;
+  }
+
+  // Split background into components
+  bg_r = (bg >> 16) & 0xff;
+  bg_g = (bg >> 8) & 0xff;
+  bg_b = bg & 0xff;
+
+  // Alpha blend components
+  out_r = (fg_r * alpha + bg_r * (255 - alpha)) / 255;
+  out_g = (fg_g * alpha + bg_g * (255 - alpha)) / 255;
+  out_b = (fg_b * alpha + bg_b * (255 - alpha)) / 255;
+
+  // Pack result
+  return (out_r << 16) | (out_g << 8) | out_b;
+}
+
+// Instantiation of the drawing functions for each pixel format
+#define UI_FN_CONCAT(name, suffix) name##_##suffix
+#define UI_FN_EXPAND(name, suffix) UI_FN_CONCAT(name, suffix)
+#define UI_FN(name) UI_FN_EXPAND(name, PIXEL_SUFFIX)
+
+#define PIXEL_T uint16_t
+#define BLEND blend16
+#define PIXEL_SUFFIX 16
+#include "ui_draw.inc"
+#undef PIXEL_T
+#undef BLEND
+#undef PIXEL_SUFFIX
+
+#define PIXEL_T uint32_t
+#define BLEND blend32
+#define PIXEL_SUFFIX 32
+#include "ui_draw.inc"
+#undef PIXEL_T
+#undef BLEND
+#undef PIXEL_SUFFIX
+
 void draw_bmp(int x, int y, const uint16_t *img, int img_width, int img_height)
 {
-  int i, j;
-  for (j = 0; j < img_height; j++)
+  if (vkb_pixel_format == VKB_PIXEL_XRGB8888)
   {
-    uint16_t *screen_line = vkb_video_buffer + ((y + j) * vkb_screen_width) + x;
-    const uint16_t *img_line = img + j * img_width;
-    for (i = 0; i < img_width; i++)
-    {
-      screen_line[i] = blend(img_line[i], screen_line[i], vkb_alpha);
-    }
+    draw_bmp_32(x, y, img, img_width, img_height);
+  }
+  else
+  {
+    draw_bmp_16(x, y, img, img_width, img_height);
   }
 }
 
 void draw_box(int x, int y, int width, int height, int thickness, uint16_t color)
 {
-  int i, j, k;
-  for (k = 0; k < thickness; k++)
+  if (vkb_pixel_format == VKB_PIXEL_XRGB8888)
+  {
+    draw_box_32(x, y, width, height, thickness, color);
+  }
+  else
   {
-    uint16_t *screen_line_up = vkb_video_buffer + ((y + k) * vkb_screen_width);
-    uint16_t *screen_line_down = vkb_video_buffer + ((y + k + height - 1) * vkb_screen_width);
-    for (i = x; i < x + width + thickness; i++)
-    {
-      screen_line_up[i] = blend(color, screen_line_up[i], vkb_alpha);
-      screen_line_down[i] = blend(color, screen_line_down[i], vkb_alpha);
-    }
-    for (j = y; j < y + height; j++)
-    {
-      int offset = (j * vkb_screen_width) + x + k;
-      vkb_video_buffer[offset] = blend(color, vkb_video_buffer[offset], vkb_alpha);
-      vkb_video_buffer[offset + width] = blend(color, vkb_video_buffer[offset + width], vkb_alpha);
-    }
+    draw_box_16(x, y, width, height, thickness, color);
   }
 }
@@ -23,7 +23,7 @@
 
 #include <stdint.h>
 
-// Draw an image at the given position
+// Draw an image (16-bit pixels) at the given position
 extern void draw_bmp(int x, int y, const uint16_t *img, int img_width, int img_height);
 // Draw a colored box at the given position
 extern void draw_box(int x, int y, int width, int height, int thickness, uint16_t color);
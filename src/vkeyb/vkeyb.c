@@ -50,14 +50,23 @@ static uint16_t color_hold = 0x06DF;
 
 static int box_thickness = 2;
 
-void vkb_configure_virtual_keyboard(uint16_t *video_buffer, int width, int height)
+void vkb_configure_virtual_keyboard(void *video_buffer, int width, int height,
+                                    enum VkbPixelFormat format)
 {
-  vkb_video_buffer = video_buffer;
+  vkb_pixel_format = format;
   vkb_screen_width = width;
   vkb_screen_height = height;
+  vkb_set_video_buffer(video_buffer,
+                       width * ((format == VKB_PIXEL_XRGB8888) ? sizeof(uint32_t) : sizeof(uint16_t)));
   vkb_set_virtual_keyboard_model(VKB_MODEL_TO8);
 }
 
+void vkb_set_video_buffer(void *video_buffer, int pitch)
+{
+  vkb_video_buffer = video_buffer;
+  vkb_screen_pitch = pitch;
+}
+
 void vkb_set_virtual_keyboard_model(enum VkbModel model)
 {
   vkb_release_all_sticky_keys();
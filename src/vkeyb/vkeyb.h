@@ -34,9 +34,15 @@ enum VkbPosition { VKB_POS_DOWN, VKB_POS_UP };
 // Virtual keyboard models
 enum VkbModel { VKB_MODEL_MO5, VKB_MODEL_MO6, VKB_MODEL_PC128,
                 VKB_MODEL_TO7, VKB_MODEL_TO770, VKB_MODEL_TO8 };
+// Pixel formats of the video buffer
+// (RGB565 is ABGR1555 when SUPPORT_ABGR1555 is defined)
+enum VkbPixelFormat { VKB_PIXEL_RGB565, VKB_PIXEL_XRGB8888 };
 
 // Configure the virtual keyboard feature
-extern void vkb_configure_virtual_keyboard(uint16_t *video_buffer, int width, int height);
+extern void vkb_configure_virtual_keyboard(void *video_buffer, int width, int height,
+                                           enum VkbPixelFormat format);
+// Set the video buffer to draw into (pitch = length in bytes between two lines)
+extern void vkb_set_video_buffer(void *video_buffer, int pitch);
 // Set the virtual keyboard model
 extern void vkb_set_virtual_keyboard_model(enum VkbModel model);
 // Set the virtual keyboard transparency (0 = transparent, 255 = opaque)
@@ -20,7 +20,9 @@
 
 #include "vkeyb_config.h"
 
-uint16_t *vkb_video_buffer = 0;
+void *vkb_video_buffer = 0;
+enum VkbPixelFormat vkb_pixel_format = VKB_PIXEL_RGB565;
 int vkb_screen_width = 0;
 int vkb_screen_height = 0;
+int vkb_screen_pitch = 0;
 int vkb_alpha = 255;
@@ -22,10 +22,14 @@
 #define __CONFIG_H
 
 #include <stdint.h>
+#include "vkeyb.h"
 
-extern uint16_t *vkb_video_buffer;
+extern void *vkb_video_buffer;
+extern enum VkbPixelFormat vkb_pixel_format;
 extern int vkb_screen_width;
 extern int vkb_screen_height;
+// Length in bytes between two lines of the video buffer
+extern int vkb_screen_pitch;
 extern int vkb_alpha;
 
 #endif /* __CONFIG_H */